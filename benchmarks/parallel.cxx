@@ -0,0 +1,108 @@
+// g++ -O2 -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM parallel.cxx -lpthread
+// ./a.out [ max threads ] [ elements ]
+//
+// parallel_for / parallel_reduce against a plain sequential loop and a manually chunked
+// version ( one chunk per thread , enqueue + join ) on 1 .. max threads ; best of a few runs.
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+
+#include "../thread_pool.hxx"
+#include "../parallel.hxx"
+#include "../work_stealing_queue.hxx"
+#include "../task.hxx"
+
+using pool_type = multi::thread_pool< multi::work_stealing_queue< multi::task > > ;
+
+static void work ( double& value ) { value = std::sqrt( value * 1.0001 + 1.0 ) ; }
+
+template < class Func >
+double best_ms ( Func func , std::size_t const runs = 5 )
+{
+    using namespace std::chrono ;
+
+    double best = 0 ;
+    for ( std::size_t count = 0 ; count < runs ; ++ count )
+    {
+        auto const started = steady_clock::now() ;
+        func() ;
+        double const spent = duration< double , std::milli >( steady_clock::now() - started ).count() ;
+
+        if ( ! count || spent < best )
+            best = spent ;
+    }
+    return best ;
+}
+
+int main ( int argc , char ** argv )
+{
+    std::size_t const max_threads = argc > 1 ? std::strtoul( argv[ 1 ] , nullptr , 10 )
+                                             : std::max( std::thread::hardware_concurrency() , 1u ) ;
+    std::size_t const size = argc > 2 ? std::strtoul( argv[ 2 ] , nullptr , 10 ) : 1 << 22 ;
+
+    std::vector< double > data ( size , 1.0 ) ;
+    double volatile sink = 0 ;
+
+    std::cout << "elements : " << size << "\n"
+              << std::setw( 8 ) << "threads"
+              << std::setw( 14 ) << "for seq" << std::setw( 14 ) << "for manual" << std::setw( 14 ) << "parallel_for"
+              << std::setw( 14 ) << "sum seq" << std::setw( 14 ) << "sum manual" << std::setw( 16 ) << "parallel_reduce"
+              << "   ( ms )\n" ;
+
+    for ( std::size_t threads = 1 ; threads <= max_threads ; ++ threads )
+    {
+        pool_type pool { threads } ;
+
+        double const for_seq = best_ms( [ & ] () {
+            std::for_each( data.begin() , data.end() , &work ) ;
+        } ) ;
+
+        double const for_manual = best_ms( [ & ] () {
+            std::size_t const chunk = ( size + threads - 1 ) / threads ;
+            for ( std::size_t from = 0 ; from < size ; from += chunk )
+                pool.emplace( [ & , from , chunk ] () {
+                    std::for_each( data.begin() + from , data.begin() + std::min( from + chunk , size ) , &work ) ;
+                } ) ;
+            pool.join() ;
+        } ) ;
+
+        double const for_parallel = best_ms( [ & ] () {
+            multi::parallel_for( pool , data.begin() , data.end() , &work ) ;
+        } ) ;
+
+        double const sum_seq = best_ms( [ & ] () {
+            sink = std::accumulate( data.begin() , data.end() , 0.0 ) ;
+        } ) ;
+
+        double const sum_manual = best_ms( [ & ] () {
+            std::size_t const chunk = ( size + threads - 1 ) / threads ;
+            std::vector< double > partial ( threads * 8 ) ; // a cache line per chunk
+            for ( std::size_t from = 0 , index = 0 ; from < size ; from += chunk , index += 8 )
+                pool.emplace( [ & , from , chunk , index ] () {
+                    partial[ index ] = std::accumulate( data.begin() + from ,
+                                                        data.begin() + std::min( from + chunk , size ) , 0.0 ) ;
+                } ) ;
+            pool.join() ;
+            sink = std::accumulate( partial.begin() , partial.end() , 0.0 ) ;
+        } ) ;
+
+        double const sum_parallel = best_ms( [ & ] () {
+            sink = multi::parallel_reduce( pool , data.begin() , data.end() , 0.0 , std::plus< double >{} ) ;
+        } ) ;
+
+        std::cout << std::fixed << std::setprecision( 2 )
+                  << std::setw( 8 ) << threads
+                  << std::setw( 14 ) << for_seq << std::setw( 14 ) << for_manual << std::setw( 14 ) << for_parallel
+                  << std::setw( 14 ) << sum_seq << std::setw( 14 ) << sum_manual << std::setw( 16 ) << sum_parallel
+                  << "\n" ;
+    }
+
+    return sink < 0 ;
+}
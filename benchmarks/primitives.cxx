@@ -0,0 +1,260 @@
+// g++ -O2 -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM primitives.cxx -lpthread
+// ./a.out [ max threads ] [ scale ]
+//
+// multi::mutex / condition_variable / thread_pool against their std:: counterparts ; the std pool is
+// the textbook one ( std::queue of std::function , std::mutex , std::condition_variable ).
+// thread counts are 1 , 2 , 4 .. max ; work sizes are fixed , so runs on the same machine are comparable.
+// scale multiplies the number of operations ( 1 by default ). best of a few runs , lower is better.
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+#include <algorithm>
+
+#include "../thread_pool.hxx"
+#include "../mutex.hxx"
+#include "../condition_variable.hxx"
+#include "../work_stealing_queue.hxx"
+#include "../task.hxx"
+
+template < class Func >
+double best_ms ( Func func , std::size_t const runs = 5 )
+{
+    using namespace std::chrono ;
+
+    double best = 0 ;
+    for ( std::size_t count = 0 ; count < runs ; ++ count )
+    {
+        auto const started = steady_clock::now() ;
+        func() ;
+        double const spent = duration< double , std::milli >( steady_clock::now() - started ).count() ;
+
+        if ( ! count || spent < best )
+            best = spent ;
+    }
+    return best ;
+}
+
+template < class Func >
+void run_threads ( std::size_t const threads , Func func )
+{
+    std::vector< std::thread > workers ;
+    for ( std::size_t index = 0 ; index < threads ; ++ index )
+        workers.emplace_back( func , index ) ;
+    for ( auto& each : workers )
+        each.join() ;
+}
+
+// every thread increments a shared counter under the mutex
+template < class Mutex >
+double lock_ms ( std::size_t const threads , std::size_t const total )
+{
+    Mutex mtx ;
+    std::size_t volatile counter = 0 ;
+
+    return best_ms( [ & ] () {
+        run_threads( threads , [ & ] ( std::size_t ) {
+            for ( std::size_t count = 0 ; count < total / threads ; ++ count ) {
+                mtx.lock() ;
+                counter = counter + 1 ;
+                mtx.unlock() ;
+            }
+        } ) ;
+    } ) ;
+}
+
+// pairs of threads pass a token back and forth
+template < class Mutex , class CondVar , template < class > class Lock >
+double ping_pong_ms ( std::size_t const threads , std::size_t const total )
+{
+    struct channel
+    {
+        Mutex mtx ;
+        CondVar cv ;
+        std::size_t turn = 0 ;
+        char padding [ 64 ] ; // pairs do not share cache lines
+    } ;
+
+    std::size_t const pairs = threads / 2 ? threads / 2 : 1 ;
+    std::size_t const rounds = total / pairs ;
+
+    return best_ms( [ & ] () {
+        std::vector< channel > channels ( pairs ) ;
+
+        run_threads( pairs * 2 , [ & ] ( std::size_t const index ) {
+            channel& chan = channels[ index / 2 ] ;
+            std::size_t const side = index % 2 ;
+
+            for ( std::size_t count = 0 ; count < rounds ; ++ count ) {
+                Lock< Mutex > lock { chan.mtx } ;
+                chan.cv.wait( lock , [ & ] () { return chan.turn % 2 == side ; } ) ;
+                ++ chan.turn ;
+                chan.cv.notify_one() ;
+            }
+        } ) ;
+    } , 3 ) ;
+}
+
+struct std_pool
+{
+    explicit std_pool ( std::size_t const threads )
+    {
+        for ( std::size_t index = 0 ; index < threads ; ++ index )
+            workers_.emplace_back( &std_pool::routine_ , this ) ;
+    }
+
+    ~ std_pool ()
+    {
+        {
+            std::lock_guard< std::mutex > lock { mtx_ } ;
+            is_done_ = true ;
+        }
+        cv_.notify_all() ;
+        for ( auto& each : workers_ )
+            each.join() ;
+    }
+
+    void enqueue ( std::function< void () > task )
+    {
+        {
+            std::lock_guard< std::mutex > lock { mtx_ } ;
+            queue_.push( std::move( task ) ) ;
+            ++ pending_ ;
+        }
+        cv_.notify_one() ;
+    }
+
+    void join ()
+    {
+        std::unique_lock< std::mutex > lock { mtx_ } ;
+        join_cv_.wait( lock , [ this ] () { return pending_ == 0 ; } ) ;
+    }
+
+    private :
+        void routine_ ()
+        {
+            std::unique_lock< std::mutex > lock { mtx_ } ;
+            for ( ; ; )
+            {
+                cv_.wait( lock , [ this ] () { return is_done_ || ! queue_.empty() ; } ) ;
+                if ( queue_.empty() )
+                    return ;
+
+                std::function< void () > task = std::move( queue_.front() ) ;
+                queue_.pop() ;
+
+                lock.unlock() ;
+                task() ;
+                lock.lock() ;
+
+                if ( -- pending_ == 0 )
+                    join_cv_.notify_all() ;
+            }
+        }
+
+        std::mutex mtx_ ;
+        std::condition_variable cv_ , join_cv_ ;
+        std::queue< std::function< void () > > queue_ ;
+        std::size_t pending_ = 0 ;
+        bool is_done_ = false ;
+        std::vector< std::thread > workers_ ;
+} ;
+
+// a task spins over work iterations , so its size does not depend on the timer resolution
+static void spin ( std::size_t const work )
+{
+    std::size_t volatile sink = 0 ;
+    for ( std::size_t count = 0 ; count < work ; ++ count )
+        sink = sink + count ;
+}
+
+template < class Pool >
+double pool_ms ( Pool& pool , std::size_t const tasks , std::size_t const work )
+{
+    return best_ms( [ & ] () {
+        for ( std::size_t count = 0 ; count < tasks ; ++ count )
+            pool.enqueue( [ work ] () { spin( work ) ; } ) ;
+        pool.join() ;
+    } ) ;
+}
+
+int main ( int argc , char ** argv )
+{
+    std::size_t const max_threads = std::max< std::size_t >( argc > 1 ? std::strtoul( argv[ 1 ] , nullptr , 10 )
+                                                                      : std::thread::hardware_concurrency() , 1 ) ;
+    std::size_t const scale = argc > 2 ? std::strtoul( argv[ 2 ] , nullptr , 10 ) : 1 ;
+
+    std::vector< std::size_t > thread_counts ;
+    for ( std::size_t threads = 1 ; threads < max_threads ; threads *= 2 )
+        thread_counts.push_back( threads ) ;
+    thread_counts.push_back( max_threads ) ;
+
+    std::cout << std::fixed << std::setprecision( 2 ) ;
+
+    std::size_t const locks = 1000000 * scale ;
+    std::cout << "mutex : " << locks << " lock / unlock in total   ( ms )\n"
+              << std::setw( 8 ) << "threads" << std::setw( 14 ) << "std" << std::setw( 14 ) << "multi" << "\n" ;
+    for ( std::size_t const threads : thread_counts )
+        std::cout << std::setw( 8 ) << threads
+                  << std::setw( 14 ) << lock_ms< std::mutex >( threads , locks )
+                  << std::setw( 14 ) << lock_ms< multi::mutex >( threads , locks ) << "\n" ;
+
+    std::size_t const passes = 20000 * scale ;
+    std::cout << "\ncondition_variable : " << passes << " passes in total   ( ms )\n"
+              << std::setw( 8 ) << "threads" << std::setw( 14 ) << "std" << std::setw( 14 ) << "multi" << "\n" ;
+    for ( std::size_t const threads : thread_counts )
+    {
+        if ( threads < 2 && max_threads >= 2 ) // the same 2 threads as the next row
+            continue ;
+
+        std::cout << std::setw( 8 ) << ( threads < 2 ? 2 : threads / 2 * 2 )
+                  << std::setw( 14 ) << ping_pong_ms< std::mutex , std::condition_variable , std::unique_lock >( threads , passes )
+                  << std::setw( 14 ) << ping_pong_ms< multi::mutex , multi::condition_variable , multi::unique_lock >( threads , passes )
+                  << "\n" ;
+    }
+
+    using function_queue = std::queue< std::function< void () > > ;
+    using locked_pool    = multi::thread_pool< function_queue > ;
+    using stealing_pool  = multi::thread_pool< multi::work_stealing_queue< multi::task > > ;
+    using stats_pool     = multi::thread_pool< multi::work_stealing_queue< multi::task > ,
+                                               multi::RethrowThreadException , multi::CollectPoolStats > ;
+
+    std::size_t const tasks = 100000 * scale ;
+    for ( std::size_t const work : { 0 , 100 , 10000 } )
+    {
+        std::size_t const task_count = work < 10000 ? tasks : tasks / 10 ;
+
+        std::cout << "\nthread_pool : " << task_count << " tasks of " << work << " iterations   ( ms )\n"
+                  << std::setw( 8 ) << "threads" << std::setw( 14 ) << "std" << std::setw( 14 ) << "locked"
+                  << std::setw( 14 ) << "stealing" << std::setw( 16 ) << "stealing+stats" << "\n" ;
+
+        for ( std::size_t const threads : thread_counts )
+        {
+            std_pool std_one { threads } ;
+            locked_pool locked { threads } ;
+            stealing_pool stealing { threads } ;
+            stats_pool with_stats { threads } ;
+
+            std::cout << std::setw( 8 ) << threads
+                      << std::setw( 14 ) << pool_ms( std_one , task_count , work )
+                      << std::setw( 14 ) << pool_ms( locked , task_count , work )
+                      << std::setw( 14 ) << pool_ms( stealing , task_count , work )
+                      << std::setw( 16 ) << pool_ms( with_stats , task_count , work ) << "\n" ;
+        }
+    }
+
+    { // what the instrumentation sees for the cheapest tasks on all threads
+        stats_pool pool { max_threads } ;
+        pool_ms( pool , tasks , 0 ) ;
+
+        std::cout << "\nstats of stealing+stats , " << max_threads << " threads , 5 x " << tasks << " empty tasks :\n"
+                  << pool.stats_policy().snapshot() ;
+    }
+}
@@ -1,5 +1,7 @@
 #ifdef MULTI_POSIX_PLATFORM
     #include "sources/POSIX/condition_variable.hxx"
+#elif defined MULTI_LINUX_FUTEX_PLATFORM
+    #include "sources/LinuxFutex/condition_variable.hxx"
 #elif MULTI_WINAPI_PLATFORM
     #include "sources/WinAPI/condition_variable.hxx"
 #endif
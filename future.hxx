@@ -0,0 +1,473 @@
+#ifndef MULTI_FUTURE_HXX
+#define MULTI_FUTURE_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#include "mutex.hxx"
+#include "condition_variable.hxx"
+
+namespace multi
+{
+    enum struct future_errc
+    {
+        broken_promise = 1 ,
+        future_already_retrieved ,
+        promise_already_satisfied ,
+        no_state
+    } ;
+
+    enum struct future_status
+    {
+        ready ,
+        timeout
+    } ;
+
+    struct future_error final
+        : std::logic_error
+    {
+        explicit future_error ( future_errc const code )
+            : std::logic_error{ message_( code ) } , code_{ code }
+        {
+        }
+
+        future_errc code () const noexcept { return code_ ; }
+
+        private :
+            static char const * message_ ( future_errc const code ) noexcept
+            {
+                switch ( code ) {
+                    case future_errc::broken_promise            : return "broken promise" ;
+                    case future_errc::future_already_retrieved  : return "future already retrieved" ;
+                    case future_errc::promise_already_satisfied : return "promise already satisfied" ;
+                    case future_errc::no_state                  : return "no associated state" ;
+                }
+                return "unknown future error" ;
+            }
+
+            future_errc code_ ;
+    } ;
+
+    template < class R > struct future ;
+    template < class R > struct promise ;
+
+    namespace p_
+    {
+        template < class R >
+        struct result_storage
+        {
+            result_storage () noexcept : has_value_{ false } { }
+
+            ~ result_storage ()
+            {
+                if ( has_value_ )
+                    reinterpret_cast< R * >( &storage_ ) -> ~ R() ;
+            }
+
+            template < class... Args >
+            void construct ( Args&&... args )
+            {
+                ::new ( &storage_ ) R( std::forward< Args >( args )... ) ;
+                has_value_ = true ;
+            }
+
+            R take () { return std::move( * reinterpret_cast< R * >( &storage_ ) ) ; }
+
+            private :
+                typename std::aligned_storage< sizeof( R ) , alignof( R ) >::type storage_ ;
+                bool has_value_ ;
+        } ;
+
+        template < class R >
+        struct result_storage< R& >
+        {
+            void construct ( R& value ) noexcept { ptr_ = std::addressof( value ) ; }
+            R& take () noexcept { return * ptr_ ; }
+
+            private :
+                R * ptr_ = nullptr ;
+        } ;
+
+        template < >
+        struct result_storage< void >
+        {
+            void construct () noexcept { }
+            void take () noexcept { }
+        } ;
+
+        // shared by a promise ( or a pool task ) and a future ; intrusively counted ,
+        // so that a task , its callable and the result live in one allocation.
+        template < class R >
+        struct shared_state
+        {
+            shared_state ()
+                : refs_{ 1 } , ready_{ false } , retrieved_{ false } , waiters_{ 0 }
+            {
+            }
+
+            shared_state ( shared_state const& ) = delete ;
+            shared_state& operator = ( shared_state const& ) = delete ;
+
+            virtual ~ shared_state () = default ;
+
+            void add_ref () noexcept { refs_.fetch_add( 1 , std::memory_order_relaxed ) ; }
+
+            void release () noexcept
+            {
+                if ( refs_.fetch_sub( 1 , std::memory_order_acq_rel ) == 1 )
+                    delete this ;
+            }
+
+            template < class... Args >
+            void set_value ( Args&&... args )
+            {
+                lock_guard< multi::mutex > lock { mtx_ } ;
+
+                if ( ready_ )
+                    throw future_error{ future_errc::promise_already_satisfied } ;
+
+                result_.construct( std::forward< Args >( args )... ) ;
+                make_ready_() ;
+            }
+
+            void set_exception ( std::exception_ptr ptr )
+            {
+                lock_guard< multi::mutex > lock { mtx_ } ;
+
+                if ( ready_ )
+                    throw future_error{ future_errc::promise_already_satisfied } ;
+
+                error_ = std::move( ptr ) ;
+                make_ready_() ;
+            }
+
+            void abandon () noexcept // broken_promise , unless the result is already there
+            {
+                try {
+                    lock_guard< multi::mutex > lock { mtx_ } ;
+                    if ( ready_ )
+                        return ;
+                    error_ = std::make_exception_ptr( future_error{ future_errc::broken_promise } ) ;
+                    make_ready_() ;
+                }
+                catch ( ... ) { }
+            }
+
+            void mark_retrieved ()
+            {
+                lock_guard< multi::mutex > lock { mtx_ } ;
+
+                if ( retrieved_ )
+                    throw future_error{ future_errc::future_already_retrieved } ;
+                retrieved_ = true ;
+            }
+
+            void wait ()
+            {
+                unique_lock< multi::mutex > lock { mtx_ } ;
+
+                ++ waiters_ ;
+                try { cv_.wait( lock , [ this ] () { return ready_ ; } ) ; }
+                catch ( ... ) {
+                    -- waiters_ ;
+                    throw ;
+                }
+                -- waiters_ ;
+            }
+
+            template < class Clock , class Duration >
+            bool wait_until ( std::chrono::time_point< Clock , Duration > const& timeout_time )
+            {
+                unique_lock< multi::mutex > lock { mtx_ } ;
+
+                ++ waiters_ ;
+                bool is_ready ;
+                try { is_ready = cv_.wait_until( lock , timeout_time , [ this ] () { return ready_ ; } ) ; }
+                catch ( ... ) {
+                    -- waiters_ ;
+                    throw ;
+                }
+                -- waiters_ ;
+                return is_ready ;
+            }
+
+            bool is_ready ()
+            {
+                lock_guard< multi::mutex > lock { mtx_ } ;
+                return ready_ ;
+            }
+
+            R get ()
+            {
+                wait() ;
+
+                if ( error_ )
+                    std::rethrow_exception( error_ ) ;
+                return result_.take() ;
+            }
+
+            protected :
+
+                void make_ready_ () noexcept // mtx_
+                {
+                    ready_ = true ;
+                    if ( waiters_ ) // nobody to wake up in the common case of get () after completion
+                        cv_.notify_all() ;
+                }
+
+            private :
+                std::atomic< unsigned > refs_ ;
+
+                multi::mutex mtx_ ;
+                multi::condition_variable cv_ ;
+
+                result_storage< R > result_ ; // mtx_ until ready_
+                std::exception_ptr error_ ;   // mtx_ until ready_
+                bool ready_ , retrieved_ ;
+                unsigned waiters_ ;
+        } ;
+
+        template < class R >
+        struct state_ptr final
+        {
+            state_ptr () noexcept : ptr_{ nullptr } { }
+            explicit state_ptr ( shared_state< R > * ptr ) noexcept : ptr_{ ptr } { } // adopts the reference
+
+            state_ptr ( state_ptr const& src ) noexcept
+                : ptr_{ src.ptr_ }
+            {
+                if ( ptr_ ) ptr_ -> add_ref() ;
+            }
+
+            state_ptr ( state_ptr&& src ) noexcept
+                : ptr_{ src.ptr_ }
+            {
+                src.ptr_ = nullptr ;
+            }
+
+            state_ptr& operator = ( state_ptr src ) noexcept
+            {
+                std::swap( ptr_ , src.ptr_ ) ;
+                return * this ;
+            }
+
+            ~ state_ptr () { if ( ptr_ ) ptr_ -> release() ; }
+
+            shared_state< R > * operator -> () const noexcept { return ptr_ ; }
+            shared_state< R > * get () const noexcept { return ptr_ ; }
+            explicit operator bool () const noexcept { return ptr_ != nullptr ; }
+
+            private :
+                shared_state< R > * ptr_ ;
+        } ;
+
+        template < class R , class F >
+        struct task_state final
+            : shared_state< R >
+        {
+            explicit task_state ( F func ) : func_( std::move( func ) ) { }
+
+            void run () noexcept
+            {
+                try { run_( std::is_void< R >{} ) ; }
+                catch ( ... ) {
+                    try { this -> set_exception( std::current_exception() ) ; }
+                    catch ( ... ) { }
+                }
+            }
+
+            private :
+                void run_ ( std::true_type )  { func_() ; this -> set_value() ; }
+                void run_ ( std::false_type ) { this -> set_value( func_() ) ; }
+
+                F func_ ;
+        } ;
+
+        // what is actually enqueued : a pointer to the task_state ;
+        // if it is destroyed without being run ( discarded queue ) , the future gets broken_promise.
+        template < class R , class F >
+        struct task_runner final
+        {
+            explicit task_runner ( task_state< R , F > * state ) noexcept
+                : state_{ state }
+            {
+            }
+
+            task_runner ( task_runner const& src ) noexcept
+                : state_{ src.state_ }
+            {
+                if ( state_ ) state_ -> add_ref() ;
+            }
+
+            task_runner ( task_runner&& src ) noexcept
+                : state_{ src.state_ }
+            {
+                src.state_ = nullptr ;
+            }
+
+            task_runner& operator = ( task_runner src ) noexcept
+            {
+                std::swap( state_ , src.state_ ) ;
+                return * this ;
+            }
+
+            ~ task_runner ()
+            {
+                if ( state_ ) {
+                    state_ -> abandon() ;
+                    state_ -> release() ;
+                }
+            }
+
+            void operator () ()
+            {
+                task_state< R , F > * state = state_ ;
+                state_ = nullptr ;
+
+                state -> run() ;
+                state -> release() ;
+            }
+
+            private :
+                task_state< R , F > * state_ ;
+        } ;
+
+        struct future_access final
+        {
+            template < class R >
+            static future< R > create ( state_ptr< R > state )
+            {
+                return future< R >( std::move( state ) ) ;
+            }
+        } ;
+    }
+
+    template < class R >
+    struct future final
+    {
+        future () noexcept = default ;
+
+        future ( future const& ) = delete ;
+        future& operator = ( future const& ) = delete ;
+
+        future ( future&& ) noexcept = default ;
+        future& operator = ( future&& ) noexcept = default ;
+
+        bool valid () const noexcept { return static_cast< bool >( state_ ) ; }
+
+        bool is_ready () const
+        {
+            check_state_() ;
+            return state_ -> is_ready() ;
+        }
+
+        R get () // the future is not valid after this call
+        {
+            check_state_() ;
+            p_::state_ptr< R > state = std::move( state_ ) ;
+            return state -> get() ;
+        }
+
+        void wait () const
+        {
+            check_state_() ;
+            state_ -> wait() ;
+        }
+
+        template < class Rep , class Period >
+        future_status wait_for ( std::chrono::duration< Rep , Period > const& timeout_duration ) const
+        {
+            return wait_until( std::chrono::steady_clock::now() + timeout_duration ) ;
+        }
+
+        template < class Clock , class Duration >
+        future_status wait_until ( std::chrono::time_point< Clock , Duration > const& timeout_time ) const
+        {
+            check_state_() ;
+            return state_ -> wait_until( timeout_time ) ? future_status::ready
+                                                        : future_status::timeout ;
+        }
+
+        private :
+            friend p_::future_access ;
+
+            explicit future ( p_::state_ptr< R > state ) noexcept
+                : state_( std::move( state ) )
+            {
+            }
+
+            void check_state_ () const
+            {
+                if ( ! state_ )
+                    throw future_error{ future_errc::no_state } ;
+            }
+
+            p_::state_ptr< R > state_ ;
+    } ;
+
+    template < class R >
+    struct promise final
+    {
+        promise ()
+            : state_{ new p_::shared_state< R > }
+        {
+        }
+
+        promise ( promise const& ) = delete ;
+        promise& operator = ( promise const& ) = delete ;
+
+        promise ( promise&& ) noexcept = default ;
+
+        promise& operator = ( promise&& src ) noexcept
+        {
+            promise( std::move( src ) ).swap( * this ) ;
+            return * this ;
+        }
+
+        ~ promise ()
+        {
+            if ( state_ )
+                state_ -> abandon() ;
+        }
+
+        void swap ( promise& obj ) noexcept { std::swap( state_ , obj.state_ ) ; }
+
+        future< R > get_future ()
+        {
+            check_state_() ;
+            state_ -> mark_retrieved() ;
+            return p_::future_access::create( state_ ) ;
+        }
+
+        template < class... Args > // nothing for promise< void > , a reference for promise< R& >
+        void set_value ( Args&&... args )
+        {
+            check_state_() ;
+            state_ -> set_value( std::forward< Args >( args )... ) ;
+        }
+
+        void set_exception ( std::exception_ptr ptr )
+        {
+            check_state_() ;
+            state_ -> set_exception( std::move( ptr ) ) ;
+        }
+
+        private :
+            void check_state_ () const
+            {
+                if ( ! state_ )
+                    throw future_error{ future_errc::no_state } ;
+            }
+
+            p_::state_ptr< R > state_ ;
+    } ;
+}
+
+#endif // MULTI_FUTURE_HXX
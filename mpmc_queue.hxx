@@ -0,0 +1,187 @@
+#ifndef MULTI_MPMC_QUEUE_HXX
+#define MULTI_MPMC_QUEUE_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// bounded multi-producer / multi-consumer ring buffer , lock-free.
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+
+// every cell has a sequence number : the cell at position pos is free for the producer
+// if sequence == pos , and holds a value for the consumer if sequence == pos + 1 .
+// producers and consumers claim positions by CAS on their own ( padded ) counters ,
+// so they do not write to the same cache line unless the queue is nearly empty / full.
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include "queue_traits.hxx"
+
+namespace multi
+{
+    template < class T >
+    struct mpmc_queue final
+    {
+        using value_type = T ;
+        using queue_category = bounded_concurrent_queue_tag ;
+
+        static_assert( std::is_nothrow_move_constructible< value_type >::value ,
+                       "claimed cell can not be given back , so value_type must be nothrow move constructible" ) ;
+
+        static constexpr std::size_t default_capacity = 1024 ;
+
+        // capacity is rounded up to a power of two
+        explicit mpmc_queue ( std::size_t const capacity = default_capacity )
+            : mask_{ round_up_( capacity ) - 1 } ,
+              cells_( new cell_[ mask_ + 1 ] ) ,
+              enqueue_pos_{ 0 } , dequeue_pos_{ 0 }
+        {
+            for ( std::size_t pos = 0 ; pos <= mask_ ; ++ pos )
+                cells_[ pos ].sequence.store( pos , std::memory_order_relaxed ) ;
+        }
+
+        mpmc_queue ( mpmc_queue const& ) = delete ;
+        mpmc_queue& operator = ( mpmc_queue const& ) = delete ;
+
+        ~ mpmc_queue ()
+        {
+            clear() ;
+        }
+
+        bool try_push ( value_type& value ) noexcept
+        {
+            return try_emplace( std::move( value ) ) ;
+        }
+
+        // the value is constructed right in the cell ; args are not touched if the queue is full
+        template < class... Args >
+        bool try_emplace ( Args&&... args ) noexcept
+        {
+            static_assert( std::is_nothrow_constructible< value_type , Args&&... >::value ,
+                           "claimed cell can not be given back , so the construction must not throw" ) ;
+
+            std::size_t pos ;
+            cell_ * cell = claim_push_( pos ) ;
+            if ( ! cell )
+                return false ;
+
+            ::new ( &cell -> storage ) value_type( std::forward< Args >( args )... ) ;
+            cell -> sequence.store( pos + 1 , std::memory_order_release ) ;
+            return true ;
+        }
+
+        bool try_pop ( value_type& value )
+        {
+            std::size_t pos = dequeue_pos_.load( std::memory_order_relaxed ) ;
+            cell_ * cell ;
+
+            for ( ; ; )
+            {
+                cell = &cells_[ pos & mask_ ] ;
+                std::size_t const seq = cell -> sequence.load( std::memory_order_acquire ) ;
+                std::intptr_t const diff = ( std::intptr_t ) seq - ( std::intptr_t )( pos + 1 ) ;
+
+                if ( diff == 0 ) {
+                    if ( dequeue_pos_.compare_exchange_weak( pos , pos + 1 , std::memory_order_relaxed ) )
+                        break ;
+                }
+                else if ( diff < 0 )
+                    return false ; // empty
+                else
+                    pos = dequeue_pos_.load( std::memory_order_relaxed ) ;
+            }
+
+            value_type * stored = reinterpret_cast< value_type * >( &cell -> storage ) ;
+
+            auto release_cell = [ this , cell , pos , stored ] () {
+                stored -> ~ value_type() ;
+                cell -> sequence.store( pos + mask_ + 1 , std::memory_order_release ) ;
+            } ;
+
+            try { value = std::move( * stored ) ; }
+            catch ( ... ) {
+                release_cell() ;
+                throw ;
+            }
+            release_cell() ;
+            return true ;
+        }
+
+        bool empty () const noexcept // note : only a hint while there are concurrent producers
+        {
+            std::size_t const pos = dequeue_pos_.load( std::memory_order_relaxed ) ;
+            return cells_[ pos & mask_ ].sequence.load( std::memory_order_acquire ) != pos + 1 ;
+        }
+
+        std::size_t capacity () const noexcept { return mask_ + 1 ; }
+
+        std::size_t clear ()
+        {
+            std::size_t discarded = 0 ;
+            for ( value_type value ; try_pop( value ) ; )
+                ++ discarded ;
+            return discarded ;
+        }
+
+        void attach_worker () { }
+        void detach_worker () noexcept { }
+
+        private :
+
+            struct cell_
+            {
+                std::atomic< std::size_t > sequence ;
+                typename std::aligned_storage< sizeof( value_type ) , alignof( value_type ) >::type storage ;
+            } ;
+
+            static std::size_t round_up_ ( std::size_t const capacity )
+            {
+                if ( capacity < 2 )
+                    throw std::invalid_argument{ "mpmc_queue capacity must be at least 2" } ;
+
+                std::size_t power = 2 ;
+                while ( power < capacity )
+                    power <<= 1 ;
+                return power ;
+            }
+
+            cell_ * claim_push_ ( std::size_t& pos ) noexcept
+            {
+                pos = enqueue_pos_.load( std::memory_order_relaxed ) ;
+
+                for ( ; ; )
+                {
+                    cell_ * cell = &cells_[ pos & mask_ ] ;
+                    std::size_t const seq = cell -> sequence.load( std::memory_order_acquire ) ;
+                    std::intptr_t const diff = ( std::intptr_t ) seq - ( std::intptr_t ) pos ;
+
+                    if ( diff == 0 ) {
+                        if ( enqueue_pos_.compare_exchange_weak( pos , pos + 1 , std::memory_order_relaxed ) )
+                            return cell ;
+                    }
+                    else if ( diff < 0 )
+                        return nullptr ; // full
+                    else
+                        pos = enqueue_pos_.load( std::memory_order_relaxed ) ;
+                }
+            }
+
+            std::size_t const mask_ ;
+            std::unique_ptr< cell_[] > cells_ ;
+
+            char padding0_[ p_::cache_line_size ] ;
+            std::atomic< std::size_t > enqueue_pos_ ;
+            char padding1_[ p_::cache_line_size ] ;
+            std::atomic< std::size_t > dequeue_pos_ ;
+            char padding2_[ p_::cache_line_size ] ;
+    } ;
+
+    template < class T >
+    constexpr std::size_t mpmc_queue< T >::default_capacity ;
+}
+
+#endif // MULTI_MPMC_QUEUE_HXX
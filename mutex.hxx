@@ -10,6 +10,8 @@
 
 #ifdef MULTI_POSIX_PLATFORM
     #include "sources/POSIX/mutex.hxx" 
+#elif defined MULTI_LINUX_FUTEX_PLATFORM
+    #include "sources/LinuxFutex/mutex.hxx" 
 #elif defined MULTI_WINAPI_PLATFORM
     #include "sources/WinAPI/mutex.hxx" 
 #endif
@@ -0,0 +1,163 @@
+#ifndef MULTI_PARALLEL_HXX
+#define MULTI_PARALLEL_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// parallel_for / parallel_transform / parallel_reduce over random access ranges on a thread_pool.
+// a range is halved recursively : the right half goes to the pool , the left one is processed
+// in place , until the part is not longer than the grain. the waiting thread helps ( task_group ) ,
+// so idle threads take the biggest halves first ( from the front of work_stealing_queue ) ,
+// while the owner keeps splitting the rest ; it can be called from a task of the same pool.
+// grain == 0 means automatic : ranges shorter than parallel_cutoff are processed sequentially
+// on the calling thread , without the pool at all.
+// so is the whole range when the pool is paused or has no threads ( see thread_pool::is_executing ) ;
+// a pool that is paused while an algorithm runs keeps the rest of it waiting till resume ().
+// a bounded queue that is full does not block splitting : the caller runs the half itself ( task_group::run ).
+
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+
+#include "thread_pool.hxx"
+#include "task_group.hxx"
+#include "queue_traits.hxx"
+#include "future.hxx"
+
+namespace multi
+{
+    constexpr std::size_t parallel_cutoff = 2048 ;
+
+    namespace p_
+    {
+        constexpr std::size_t chunks_per_thread = 4 ;
+
+        // the caller takes part in the work too , hence + 1
+        template < class Pool >
+        std::size_t grain_ ( Pool& pool , std::size_t const size , std::size_t const grain )
+        {
+            if ( ! pool.is_executing() ) // nobody would take the halves
+                return size ;
+
+            if ( grain )
+                return grain ;
+
+            if ( size < parallel_cutoff )
+                return size ;
+
+            return std::max( size / ( chunks_per_thread * ( pool.thread_count() + 1 ) ) ,
+                             parallel_cutoff / chunks_per_thread ) ;
+        }
+
+        // body( first , last ) for every part
+        template < class Pool , class RandomIt , class Body >
+        void split_ ( Pool& pool , RandomIt first , RandomIt last , std::size_t const grain , Body& body )
+        {
+            task_group< Pool > group { pool } ;
+
+            while ( static_cast< std::size_t >( last - first ) > grain )
+            {
+                RandomIt const middle = first + ( last - first ) / 2 ;
+                group.run( [ &pool , middle , last , grain , &body ] () {
+                    split_( pool , middle , last , grain , body ) ;
+                } ) ;
+                last = middle ;
+            }
+
+            body( first , last ) ;
+            group.wait() ;
+        }
+
+        // a partial result of the right half is written by another thread into the frame
+        // of the splitting one ; it gets a cache line of its own
+        template < class T >
+        struct alignas( cache_line_size ) padded_result_
+            : result_storage< T >
+        {
+        } ;
+
+        template < class T , class Pool , class RandomIt , class Leaf , class Combine >
+        T reduce_split_ ( Pool& pool , RandomIt first , RandomIt last , std::size_t const grain ,
+                          Leaf& leaf , Combine& combine )
+        {
+            if ( static_cast< std::size_t >( last - first ) <= grain )
+                return leaf( first , last ) ;
+
+            RandomIt const middle = first + ( last - first ) / 2 ;
+
+            padded_result_< T > right ;
+            task_group< Pool > group { pool } ; // waits for the right half before right is destroyed
+
+            group.run( [ &pool , middle , last , grain , &leaf , &combine , &right ] () {
+                right.construct( reduce_split_< T >( pool , middle , last , grain , leaf , combine ) ) ;
+            } ) ;
+
+            T left = reduce_split_< T >( pool , first , middle , grain , leaf , combine ) ;
+            group.wait() ;
+
+            return combine( std::move( left ) , right.take() ) ;
+        }
+    }
+
+    // func( *it ) for every element of [ first , last )
+    template < class Pool , class RandomIt , class UnaryFunction >
+    void parallel_for ( Pool& pool , RandomIt first , RandomIt last , UnaryFunction func ,
+                        std::size_t const grain = 0 )
+    {
+        std::size_t const size = static_cast< std::size_t >( last - first ) ;
+        if ( ! size )
+            return ;
+
+        auto body = [ &func ] ( RandomIt from , RandomIt to ) {
+            for ( ; from != to ; ++ from )
+                func( * from ) ;
+        } ;
+
+        std::size_t const part = p_::grain_( pool , size , grain ) ;
+        if ( size <= part )
+            return body( first , last ) ;
+
+        p_::split_( pool , first , last , part , body ) ;
+    }
+
+    // returns the end of the destination range , as std::transform
+    template < class Pool , class RandomIt , class OutRandomIt , class UnaryOperation >
+    OutRandomIt parallel_transform ( Pool& pool , RandomIt first , RandomIt last ,
+                                     OutRandomIt d_first , UnaryOperation op ,
+                                     std::size_t const grain = 0 )
+    {
+        std::size_t const size = static_cast< std::size_t >( last - first ) ;
+
+        auto body = [ first , d_first , &op ] ( RandomIt from , RandomIt to ) {
+            std::transform( from , to , d_first + ( from - first ) , op ) ;
+        } ;
+
+        std::size_t const part = p_::grain_( pool , size , grain ) ;
+        if ( size <= part )
+            body( first , last ) ;
+        else
+            p_::split_( pool , first , last , part , body ) ;
+
+        return d_first + size ;
+    }
+
+    // op has to be associative ; the order of the elements is kept , but not the grouping ( as std::reduce )
+    template < class Pool , class RandomIt , class T , class BinaryOperation >
+    T parallel_reduce ( Pool& pool , RandomIt first , RandomIt last , T init , BinaryOperation op ,
+                        std::size_t const grain = 0 )
+    {
+        std::size_t const size = static_cast< std::size_t >( last - first ) ;
+        if ( ! size )
+            return init ;
+
+        auto leaf = [ &op ] ( RandomIt from , RandomIt to ) {
+            return std::accumulate( std::next( from ) , to , T( * from ) , op ) ;
+        } ;
+
+        std::size_t const part = p_::grain_( pool , size , grain ) ;
+        return op( std::move( init ) , p_::reduce_split_< T >( pool , first , last , part , leaf , op ) ) ;
+    }
+}
+
+#endif // MULTI_PARALLEL_HXX
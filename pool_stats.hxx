@@ -0,0 +1,337 @@
+#ifndef MULTI_POOL_STATS_HXX
+#define MULTI_POOL_STATS_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// statistics policies of thread_pool ( the third template argument ).
+// a policy is expected to provide :
+//   static constexpr bool enabled ;               // false - the pool does not read clocks / try_lock / stamp tasks at all
+//   void worker_started () noexcept ;             // by a pool thread , before its first task
+//   void task_waited ( nanoseconds ) noexcept ;   // time from enqueue to the start of the task
+//   void task_run ( nanoseconds ) noexcept ;      // by the thread that has run the task
+//   void lock_contended () noexcept ;             // queue_mtx_ was taken by somebody else
+//   void notified ( std::size_t ) noexcept ;      // a producer issued that many notifications to idle threads
+//   void worker_woken ( bool has_work ) noexcept ; // a parked thread woke up ; without work it was futile
+//
+// CollectPoolStats keeps the numbers per thread ( a cache line padded slot each ) , so recording
+// is a few relaxed increments of thread-local data ; snapshot () merges them.
+// the queue wait is measured by stamping the task at enqueue , what requires a task_type constructible
+// from a callable ( it wraps the task , so a multi::task is kept on the heap then ) ;
+// tasks put by try_enqueue () into a bounded queue are not stamped.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+#include "queue_traits.hxx"
+
+namespace multi
+{
+    struct NoPoolStats
+    {
+        static constexpr bool enabled = false ;
+
+        void worker_started () noexcept { }
+        void task_waited ( std::chrono::nanoseconds ) noexcept { }
+        void task_run ( std::chrono::nanoseconds ) noexcept { }
+        void lock_contended () noexcept { }
+        void notified ( std::size_t ) noexcept { }
+        void worker_woken ( bool ) noexcept { }
+    } ;
+
+    // bucket i counts durations in [ 2^i , 2^(i+1) ) nanoseconds , bucket 0 also counts 0
+    struct duration_histogram
+    {
+        static constexpr std::size_t bucket_count = 64 ;
+
+        static std::size_t bucket_of ( std::chrono::nanoseconds const duration ) noexcept
+        {
+            std::uint64_t value = duration.count() > 0 ? static_cast< std::uint64_t >( duration.count() ) : 0 ;
+            std::size_t bucket = 0 ;
+            while ( value >>= 1 )
+                ++ bucket ;
+            return bucket ;
+        }
+
+        std::uint64_t count () const noexcept
+        {
+            std::uint64_t total = 0 ;
+            for ( std::uint64_t each : buckets )
+                total += each ;
+            return total ;
+        }
+
+        // upper bound of the bucket where the fraction ( 0 .. 1 ) of samples is reached
+        std::chrono::nanoseconds percentile ( double const fraction ) const noexcept
+        {
+            std::uint64_t const total = count() ;
+            std::uint64_t seen = 0 ;
+
+            for ( std::size_t bucket = 0 ; bucket < bucket_count ; ++ bucket )
+            {
+                seen += buckets[ bucket ] ;
+                if ( total && seen >= fraction * total )
+                    return bucket + 1 < 63 ? std::chrono::nanoseconds( std::int64_t( 1 ) << ( bucket + 1 ) )
+                                           : std::chrono::nanoseconds::max() ;
+            }
+            return std::chrono::nanoseconds( 0 ) ;
+        }
+
+        std::uint64_t buckets [ bucket_count ] = {} ;
+    } ;
+
+    struct pool_stats_snapshot
+    {
+        struct worker
+        {
+            std::uint64_t tasks ;
+            std::chrono::nanoseconds busy ;
+        } ;
+
+        // pool threads in the order they started ; the last one is everybody else
+        // ( clients helping in run_pending_task () , producers )
+        std::vector< worker > workers ;
+
+        duration_histogram queue_wait ;
+        duration_histogram run_time ;
+
+        std::uint64_t lock_contentions = 0 ;
+        // notifications issued , not threads woken : an idle thread may be counted as sleeping before
+        // it parks ( then it finds the task without waiting ) , and a locked pool notifies on every enqueue
+        std::uint64_t notifications = 0 ;
+        std::uint64_t wakeups = 0 ;
+        std::uint64_t futile_wakeups = 0 ;
+
+        std::uint64_t tasks () const noexcept
+        {
+            std::uint64_t total = 0 ;
+            for ( auto const& each : workers )
+                total += each.tasks ;
+            return total ;
+        }
+
+        template < class CharT , class Traits >
+        friend std::basic_ostream< CharT , Traits >&
+            operator << ( std::basic_ostream< CharT , Traits >& ost , pool_stats_snapshot const& stats )
+        {
+            ost << "tasks : " << stats.tasks() << "\n" ;
+
+            for ( std::size_t index = 0 ; index < stats.workers.size() ; ++ index )
+            {
+                ost << ( index + 1 == stats.workers.size() ? "  others" : "  worker" ) ;
+                if ( index + 1 != stats.workers.size() )
+                    ost << " " << index ;
+                ost << " : " << stats.workers[ index ].tasks << " tasks , busy "
+                    << stats.workers[ index ].busy.count() << " ns\n" ;
+            }
+
+            ost << "queue wait p50 / p99 : < " << stats.queue_wait.percentile( 0.5 ).count()
+                << " / < " << stats.queue_wait.percentile( 0.99 ).count() << " ns\n"
+                << "run time   p50 / p99 : < " << stats.run_time.percentile( 0.5 ).count()
+                << " / < " << stats.run_time.percentile( 0.99 ).count() << " ns\n"
+                << "lock contentions : " << stats.lock_contentions << "\n"
+                << "notifications / wakeups / futile : " << stats.notifications << " / "
+                << stats.wakeups << " / " << stats.futile_wakeups << "\n" ;
+            return ost ;
+        }
+    } ;
+
+    struct CollectPoolStats
+    {
+        static constexpr bool enabled = true ;
+        static constexpr std::size_t max_workers = 64 ; // the rest share the slot of non pool threads
+
+        CollectPoolStats ()
+            : slots_( new slot_[ max_workers + 1 ] ) , started_{ 0 }
+        {
+        }
+
+        CollectPoolStats ( CollectPoolStats const& ) = delete ;
+        CollectPoolStats& operator = ( CollectPoolStats const& ) = delete ;
+
+        void worker_started () noexcept
+        {
+            std::size_t const index = started_.fetch_add( 1 , std::memory_order_relaxed ) ;
+
+            context_& ctx = local_() ;
+            ctx.owner = this ;
+            ctx.index = index < max_workers ? index : max_workers ;
+        }
+
+        void task_waited ( std::chrono::nanoseconds const duration ) noexcept
+        {
+            add_( slot_for_().queue_wait[ duration_histogram::bucket_of( duration ) ] ) ;
+        }
+
+        void task_run ( std::chrono::nanoseconds const duration ) noexcept
+        {
+            slot_& slot = slot_for_() ;
+            add_( slot.tasks ) ;
+            add_( slot.busy_ns , static_cast< std::uint64_t >( duration.count() ) ) ;
+            add_( slot.run_time[ duration_histogram::bucket_of( duration ) ] ) ;
+        }
+
+        void lock_contended () noexcept { add_( slot_for_().lock_contentions ) ; }
+
+        void notified ( std::size_t const count ) noexcept { add_( slot_for_().notifications , count ) ; }
+
+        void worker_woken ( bool const has_work ) noexcept
+        {
+            slot_& slot = slot_for_() ;
+            add_( slot.wakeups ) ;
+            if ( ! has_work )
+                add_( slot.futile_wakeups ) ;
+        }
+
+        // numbers recorded concurrently with it may be partially included
+        pool_stats_snapshot snapshot () const
+        {
+            pool_stats_snapshot stats ;
+
+            std::size_t const started = started_.load( std::memory_order_relaxed ) ;
+            std::size_t const workers = started < max_workers ? started : max_workers ;
+
+            for ( std::size_t index = 0 ; index <= max_workers ; ++ index )
+            {
+                if ( index >= workers && index != max_workers )
+                    continue ;
+
+                slot_ const& slot = slots_[ index ] ;
+
+                stats.workers.push_back( pool_stats_snapshot::worker{
+                    slot.tasks.load( std::memory_order_relaxed ) ,
+                    std::chrono::nanoseconds( slot.busy_ns.load( std::memory_order_relaxed ) ) } ) ;
+
+                for ( std::size_t bucket = 0 ; bucket < duration_histogram::bucket_count ; ++ bucket ) {
+                    stats.queue_wait.buckets[ bucket ] += slot.queue_wait[ bucket ].load( std::memory_order_relaxed ) ;
+                    stats.run_time.buckets[ bucket ]   += slot.run_time[ bucket ].load( std::memory_order_relaxed ) ;
+                }
+
+                stats.lock_contentions += slot.lock_contentions.load( std::memory_order_relaxed ) ;
+                stats.notifications    += slot.notifications.load( std::memory_order_relaxed ) ;
+                stats.wakeups          += slot.wakeups.load( std::memory_order_relaxed ) ;
+                stats.futile_wakeups   += slot.futile_wakeups.load( std::memory_order_relaxed ) ;
+            }
+            return stats ;
+        }
+
+        // e.g. between benchmark rounds ; numbers recorded concurrently may survive it
+        void reset () noexcept
+        {
+            for ( std::size_t index = 0 ; index <= max_workers ; ++ index )
+            {
+                slot_& slot = slots_[ index ] ;
+
+                for ( auto* counter : { &slot.tasks , &slot.busy_ns , &slot.lock_contentions ,
+                                        &slot.notifications , &slot.wakeups , &slot.futile_wakeups } )
+                    counter -> store( 0 , std::memory_order_relaxed ) ;
+
+                for ( std::size_t bucket = 0 ; bucket < duration_histogram::bucket_count ; ++ bucket ) {
+                    slot.queue_wait[ bucket ].store( 0 , std::memory_order_relaxed ) ;
+                    slot.run_time[ bucket ].store( 0 , std::memory_order_relaxed ) ;
+                }
+            }
+        }
+
+        private :
+            using counter_t_ = std::atomic< std::uint64_t > ;
+
+            // not alignas : an over-aligned new [] is c++17 ; the padding keeps neighbouring slots
+            // off each other's cache lines anyway
+            struct slot_
+            {
+                slot_ () noexcept
+                    : tasks{ 0 } , busy_ns{ 0 } , lock_contentions{ 0 } ,
+                      notifications{ 0 } , wakeups{ 0 } , futile_wakeups{ 0 }
+                {
+                    for ( std::size_t bucket = 0 ; bucket < duration_histogram::bucket_count ; ++ bucket ) {
+                        queue_wait[ bucket ].store( 0 , std::memory_order_relaxed ) ;
+                        run_time[ bucket ].store( 0 , std::memory_order_relaxed ) ;
+                    }
+                }
+
+                counter_t_ tasks , busy_ns ;
+                counter_t_ lock_contentions , notifications , wakeups , futile_wakeups ;
+                counter_t_ queue_wait [ duration_histogram::bucket_count ] ;
+                counter_t_ run_time [ duration_histogram::bucket_count ] ;
+
+                char padding [ p_::cache_line_size ] ;
+            } ;
+
+            struct context_
+            {
+                CollectPoolStats const * owner ;
+                std::size_t index ;
+            } ;
+
+            static context_& local_ () noexcept
+            {
+                static thread_local context_ ctx { nullptr , 0 } ;
+                return ctx ;
+            }
+
+            slot_& slot_for_ () const noexcept
+            {
+                context_ const& ctx = local_() ;
+                return slots_[ ctx.owner == this ? ctx.index : max_workers ] ;
+            }
+
+            // a slot is written by its thread only , except of the shared last one ; so no read-modify-write is needed
+            // for the own slot , but the shared one needs it anyway , and the difference is not worth a branch
+            static void add_ ( counter_t_& counter , std::uint64_t const value = 1 ) noexcept
+            {
+                counter.fetch_add( value , std::memory_order_relaxed ) ;
+            }
+
+            std::unique_ptr< slot_[] > slots_ ; // max_workers + 1
+            std::atomic< std::size_t > started_ ;
+    } ;
+
+    namespace p_
+    {
+        // what is enqueued instead of the task when the stats are enabled
+        template < class Task , class Stats >
+        struct stamped_task
+        {
+            void operator () ()
+            {
+                stats -> task_waited( std::chrono::duration_cast< std::chrono::nanoseconds >(
+                                        std::chrono::steady_clock::now() - enqueued ) ) ;
+                task() ;
+            }
+
+            Stats * stats ;
+            std::chrono::steady_clock::time_point enqueued ;
+            Task task ;
+        } ;
+
+        // a wait predicate of a pool thread ; see thread_pool::watch_wakeups_
+        template < class Stats , class Predicate >
+        struct woken_predicate
+        {
+            bool operator () ()
+            {
+                bool const ready = pred() ;
+                if ( ! is_first )
+                    stats -> worker_woken( ready ) ;
+                is_first = false ;
+                return ready ;
+            }
+
+            Stats * stats ;
+            Predicate pred ;
+            bool is_first ;
+        } ;
+    }
+
+    constexpr bool NoPoolStats::enabled ;
+    constexpr bool CollectPoolStats::enabled ;
+    constexpr std::size_t CollectPoolStats::max_workers ;
+    constexpr std::size_t duration_histogram::bucket_count ;
+}
+
+#endif // MULTI_POOL_STATS_HXX
@@ -0,0 +1,59 @@
+#ifndef MULTI_QUEUE_TRAITS_HXX
+#define MULTI_QUEUE_TRAITS_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+#include <type_traits>
+#include <cstddef>
+
+namespace multi
+{
+    // queue that is safe to be used without queue_mtx_ of the thread_pool.
+    // it is expected to provide :
+    //   using value_type ;
+    //   using queue_category = concurrent_queue_tag ;
+    //   void push ( value_type ) ;
+    //   void emplace ( Args&&... ) ;
+    //   bool try_pop ( value_type& ) ;
+    //   std::size_t clear () ;             // returns number of discarded elements
+    //   void attach_worker () ;            // called by pool thread before the first try_pop
+    //   void detach_worker () noexcept ;   // called by pool thread before it exits
+    struct concurrent_queue_tag { } ;
+    
+    // concurrent queue of a fixed capacity ; it is additionally expected to provide :
+    //   bool try_push ( value_type& ) ;     // moves from the argument only on success , false if the queue is full
+    //   bool try_emplace ( Args&&... ) ;    // for nothrow construction only ; args are not touched on failure
+    // push () of such queue is not used by the pool , producers are parked by the pool instead.
+    struct bounded_concurrent_queue_tag : concurrent_queue_tag { } ;
+
+    namespace p_
+    {
+        constexpr std::size_t cache_line_size = 64 ;
+        
+        template < class Queue , class Category >
+        struct has_queue_category
+        {
+            template < class Q >
+            static std::is_base_of< Category , typename Q::queue_category > test ( int ) ;
+
+            template < class >
+            static std::false_type test ( ... ) ;
+
+            using type = decltype( test< Queue >( 0 ) ) ;
+        } ;
+    }
+
+    template < class Queue >
+    struct is_concurrent_queue
+        : p_::has_queue_category< Queue , concurrent_queue_tag >::type
+    {
+    } ;
+    
+    template < class Queue >
+    struct is_bounded_queue
+        : p_::has_queue_category< Queue , bounded_concurrent_queue_tag >::type
+    {
+    } ;
+}
+
+#endif // MULTI_QUEUE_TRAITS_HXX
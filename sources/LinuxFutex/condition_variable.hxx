@@ -0,0 +1,136 @@
+#ifndef MULTI_CONDITION_VARIABLE_HXX
+#define MULTI_CONDITION_VARIABLE_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// a waiter reads seq_ while it still holds the mutex and sleeps only while seq_ is unchanged ;
+// every notify bumps seq_ , so a notify between the unlock and the sleep is not lost.
+// waiters_ lets notify skip both the increment and the syscall when nobody is waiting.
+
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <chrono>
+
+#include "../../mutex.hxx"
+#include "futex.hxx"
+
+namespace multi
+{
+    enum struct cv_status
+    {
+        no_timeout ,
+        timeout
+    } ;
+
+    struct condition_variable final
+    {
+        using native_handle_type = p_::futex::word_t_ * ;
+
+        condition_variable () noexcept
+            : seq_{ 0 } , waiters_{ 0 }
+        {
+        }
+
+        condition_variable ( condition_variable const & ) = delete ;
+        condition_variable& operator = ( condition_variable const& ) = delete ;
+
+        ~ condition_variable () = default ;
+
+        void notify_one () noexcept
+        {
+            if ( ! waiters_.load() )
+                return ;
+
+            seq_.fetch_add( 1 ) ;
+            p_::futex::wake( &seq_ , 1 ) ;
+        }
+
+        void notify_all () noexcept
+        {
+            if ( ! waiters_.load() )
+                return ;
+
+            seq_.fetch_add( 1 ) ;
+            p_::futex::wake_all( &seq_ ) ;
+        }
+
+        void wait ( unique_lock< mutex >& lock )
+        {
+            sleep_( lock , nullptr ) ;
+        }
+
+        template < class Predicate >
+        void wait( unique_lock< mutex >& lock, Predicate pred )
+        {
+            while ( ! pred () )
+                wait( lock ) ;
+        }
+
+        template< class Clock, class Duration >
+        cv_status wait_until( unique_lock< mutex >& lock,
+                              const std::chrono::time_point< Clock , Duration >& timeout_time )
+        {
+            timespec rel ;
+            if ( ! p_::futex::remaining( timeout_time , rel ) )
+                return cv_status::timeout ;
+
+            sleep_( lock , &rel ) ;
+
+            return Clock::now() < timeout_time ? cv_status::no_timeout
+                                                : cv_status::timeout ;
+        }
+
+        template< class Clock, class Duration , class Predicate >
+        bool wait_until( unique_lock< mutex >& lock,
+                              const std::chrono::time_point< Clock, Duration >& timeout_time ,
+                              Predicate pred )
+        {
+            while ( ! pred () )
+                if ( wait_until( lock , timeout_time ) == cv_status::timeout )
+                    return pred () ;
+            return true ;
+        }
+
+        template< class Rep, class Duration >
+        cv_status wait_for( unique_lock< mutex >& lock,
+                            const std::chrono::duration< Rep , Duration >& duration )
+        {
+            return wait_until( lock , std::chrono::steady_clock::now() + duration ) ;
+        }
+
+        template< class Rep, class Duration, class Predicate >
+        bool wait_for( unique_lock< mutex >& lock,
+                         const std::chrono::duration< Rep , Duration >& duration,
+                         Predicate pred )
+        {
+            return wait_until( lock , std::chrono::steady_clock::now() + duration , std::move( pred ) ) ;
+        }
+
+        native_handle_type native_handle () noexcept /* not const */
+        {
+            return &seq_ ;
+        }
+
+        private :
+            void sleep_ ( unique_lock< mutex >& lock , timespec const * rel ) noexcept
+            {
+                auto * const mtx_p = lock.mutex() -> native_handle() ;
+
+                int const seq = seq_.load( std::memory_order_relaxed ) ;
+                waiters_.fetch_add( 1 ) ;
+
+                p_::mutex::unlock( mtx_p ) ;
+                p_::futex::wait( &seq_ , seq , rel ) ; // EAGAIN / EINTR / ETIMEDOUT are all just wake ups
+
+                waiters_.fetch_sub( 1 ) ;
+                p_::mutex::lock_contended_( mtx_p ) ;
+            }
+
+            p_::futex::word_t_ seq_ ;
+            std::atomic< unsigned > waiters_ ;
+    } ;
+}
+
+#endif // MULTI_THREAD_HXX
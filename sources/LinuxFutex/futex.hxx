@@ -0,0 +1,74 @@
+#ifndef MULTI_FUTEX_IMPL_HXX
+#define MULTI_FUTEX_IMPL_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cerrno>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+
+namespace multi
+{
+    namespace p_
+    {
+        struct futex
+        {
+            futex () = delete ;
+
+            using word_t_ = std::atomic< int > ;
+
+            static_assert( sizeof( word_t_ ) == sizeof( int ) , "futex word must be a plain int" ) ;
+
+            // sleeps while * word == expected ; relative timeout is measured against CLOCK_MONOTONIC.
+            // returns 0 when woken up ( or spuriously ) , EAGAIN if * word != expected , ETIMEDOUT , EINTR.
+            static int wait ( word_t_ * word , int expected , timespec const * timeout = nullptr ) noexcept
+            {
+                if ( syscall( SYS_futex , reinterpret_cast< int * >( word ) , FUTEX_WAIT_PRIVATE , 
+                              expected , timeout , nullptr , 0 ) == -1 )
+                    return errno ;
+                return 0 ;
+            }
+
+            static void wake ( word_t_ * word , int count ) noexcept
+            {
+                syscall( SYS_futex , reinterpret_cast< int * >( word ) , FUTEX_WAKE_PRIVATE , 
+                         count , nullptr , nullptr , 0 ) ;
+            }
+
+            static void wake_all ( word_t_ * word ) noexcept { wake( word , INT_MAX ) ; }
+
+            // false if the time is already out
+            template < class Clock , class Duration >
+            static bool remaining ( std::chrono::time_point< Clock , Duration > const& timeout_time , timespec& rel ) 
+            {
+                using namespace std::chrono ;
+
+                auto const left = duration_cast< nanoseconds >( timeout_time - Clock::now() ) ;
+                if ( left <= nanoseconds::zero() )
+                    return false ;
+
+                auto const sec = duration_cast< seconds >( left ) ;
+                rel.tv_sec  = static_cast< time_t >( sec.count() ) ;
+                rel.tv_nsec = static_cast< long >( ( left - sec ).count() ) ;
+                return true ;
+            }
+
+            static void relax () noexcept
+            {
+            #if defined __i386__ || defined __x86_64__
+                __builtin_ia32_pause() ;
+            #elif defined __aarch64__ || defined __arm__
+                asm volatile ( "yield" ) ;
+            #endif
+            }
+        } ;
+    }
+}
+
+#endif // MULTI_FUTEX_IMPL_HXX
@@ -0,0 +1,279 @@
+#ifndef MULTI_MUTEX_IMPL_HXX
+#define MULTI_MUTEX_IMPL_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// http://www.akkadia.org/drepper/futex.pdf ( mutex , take 3 )
+// the word is 0 - unlocked , 1 - locked , 2 - locked and there may be sleeping threads.
+// uncontended lock / unlock is one atomic each and no syscall ; unlock wakes only if the word was 2.
+
+#include <exception>
+#include <system_error>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "futex.hxx"
+
+namespace multi
+{
+    namespace p_
+    {
+        struct mutex
+        {
+            mutex () = delete ;
+
+            struct underlying_t_
+            {
+                futex::word_t_ word ;
+                std::atomic< int > spins ; // running average of the spins that ended with the lock taken
+            } ;
+            using native_handle_type_ = futex::word_t_ * ;
+
+            static native_handle_type_ handle ( underlying_t_ * obj_p ) { return &obj_p -> word ; }
+
+            // spinning makes sense only while the owner is running , so it stops as soon as
+            // somebody else decided to sleep ( the word is 2 ).
+            // the spin is adaptive : a waiter spins up to twice as long as the lock was recently 
+            // got by spinning ( at least min_spin , at most spin_limit ) , so locks held for long 
+            // soon stop burning cycles , while short critical sections keep avoiding the syscall.
+            static constexpr int min_spin   = 8 ;
+            static constexpr int spin_limit = 100 ;
+
+            static void init ( underlying_t_ * mtx_p ) noexcept
+            {
+                mtx_p -> word.store( 0 , std::memory_order_relaxed ) ;
+                mtx_p -> spins.store( 0 , std::memory_order_relaxed ) ;
+            }
+
+            static void destroy ( underlying_t_ * ) noexcept { }
+
+            static void lock ( underlying_t_ * mtx_p ) noexcept
+            {
+                int state = 0 ;
+                if ( mtx_p -> word.compare_exchange_strong( state , 1 , std::memory_order_acquire ,
+                                                                        std::memory_order_relaxed ) )
+                    return ;
+
+                if ( ( state = spin_( mtx_p , state ) ) != 0 )
+                    lock_contended_( &mtx_p -> word , state ) ;
+            }
+
+            static void unlock ( underlying_t_ * mtx_p ) noexcept { unlock( &mtx_p -> word ) ; }
+
+            // condition_variable gets only the word , through native_handle ()
+            static void unlock ( futex::word_t_ * word ) noexcept
+            {
+                if ( word -> exchange( 0 , std::memory_order_release ) == 2 )
+                    futex::wake( word , 1 ) ;
+            }
+
+            static bool try_lock ( underlying_t_ * mtx_p ) noexcept
+            {
+                int state = 0 ;
+                return mtx_p -> word.compare_exchange_strong( state , 1 , std::memory_order_acquire ,
+                                                                          std::memory_order_relaxed ) ;
+            }
+
+            // used by condition_variable : after a wake up there may be other sleepers , so 2 is kept
+            static void lock_contended_ ( futex::word_t_ * word , int state = 1 ) noexcept
+            {
+                if ( state != 2 )
+                    state = word -> exchange( 2 , std::memory_order_acquire ) ;
+
+                while ( state != 0 ) {
+                    futex::wait( word , 2 ) ;
+                    state = word -> exchange( 2 , std::memory_order_acquire ) ;
+                }
+            }
+
+            struct semantics // non copiable, non movable
+            {
+                semantics() = default ;
+                semantics( const semantics& ) = delete ;
+                semantics& operator = ( const semantics& ) = delete ;
+                protected :
+                    ~ semantics () = default ;
+            } ;
+
+            protected :
+                // returns the last seen state ; 0 means the lock is taken.
+                // the estimate is updated without a lock ; a lost update only makes one spin off.
+                static int spin_ ( underlying_t_ * mtx_p , int state ) noexcept
+                {
+                    int const spins = mtx_p -> spins.load( std::memory_order_relaxed ) ;
+                    int const limit = spins * 2 < min_spin   ? min_spin 
+                                    : spins * 2 > spin_limit ? spin_limit : spins * 2 ;
+
+                    int count = 0 ;
+                    while ( count < limit && state == 1 )
+                    {
+                        ++ count ;
+                        futex::relax() ;
+                        state = mtx_p -> word.load( std::memory_order_relaxed ) ;
+
+                        if ( state == 0
+                             && mtx_p -> word.compare_exchange_strong( state , 1 , std::memory_order_acquire ,
+                                                                                   std::memory_order_relaxed ) ) {
+                            mtx_p -> spins.store( spins + ( count - spins ) / 8 , std::memory_order_relaxed ) ;
+                            return 0 ;
+                        }
+                    }
+
+                    mtx_p -> spins.store( spins - spins / 8 , std::memory_order_relaxed ) ; // going to sleep
+                    return state ;
+                }
+        } ;
+
+        // FUTEX_WAIT takes a relative timeout measured against CLOCK_MONOTONIC ,
+        // so adjustments of the system clock do not shorten / prolong the wait.
+        struct timed_mutex : mutex
+        {
+            template< class Clock , class Duration >
+            static bool try_lock_until ( underlying_t_ * mtx_p , const std::chrono::time_point< Clock , Duration >& timeout_time )
+            {
+                int state = 0 ;
+                if ( mtx_p -> word.compare_exchange_strong( state , 1 , std::memory_order_acquire ,
+                                                                        std::memory_order_relaxed ) )
+                    return true ;
+
+                if ( ( state = spin_( mtx_p , state ) ) == 0 )
+                    return true ;
+
+                auto * const word = &mtx_p -> word ;
+                if ( state != 2 )
+                    state = word -> exchange( 2 , std::memory_order_acquire ) ;
+
+                timespec rel ;
+                while ( state != 0 )
+                {
+                    if ( ! futex::remaining( timeout_time , rel ) )
+                        return false ; // the word stays 2 : the next unlock does one useless wake
+
+                    futex::wait( word , 2 , &rel ) ;
+                    state = word -> exchange( 2 , std::memory_order_acquire ) ;
+                }
+                return true ;
+            }
+
+            template< class Rep, class Period >
+            static bool try_lock_for( underlying_t_ * mtx , std::chrono::duration< Rep , Period > const& timeout_duration )
+            {
+                using namespace std::chrono ;
+                return try_lock_until( mtx , steady_clock::now() + timeout_duration ) ;
+            }
+        } ;
+
+        inline std::uintptr_t thread_tag_ () noexcept // distinct for every living thread
+        {
+            static thread_local char tag ;
+            return reinterpret_cast< std::uintptr_t >( &tag ) ;
+        }
+
+        struct recursive_mutex
+        {
+            recursive_mutex () = delete ;
+
+            struct underlying_t_
+            {
+                mutex::underlying_t_ base ;
+                std::atomic< std::uintptr_t > owner ; // thread_tag_ of the owner or 0
+                unsigned count ;                      // owner only
+            } ;
+            using native_handle_type_ = futex::word_t_ * ;
+
+            static native_handle_type_ handle ( underlying_t_ * obj_p ) { return &obj_p -> base.word ; }
+
+            static void init ( underlying_t_ * mtx_p ) noexcept
+            {
+                mutex::init( &mtx_p -> base ) ;
+                mtx_p -> owner.store( 0 , std::memory_order_relaxed ) ;
+                mtx_p -> count = 0 ;
+            }
+
+            static void destroy ( underlying_t_ * ) noexcept { }
+
+            static void lock ( underlying_t_ * mtx_p ) noexcept
+            {
+                if ( reenter_( mtx_p ) )
+                    return ;
+
+                mutex::lock( &mtx_p -> base ) ;
+                acquired_( mtx_p ) ;
+            }
+
+            static void unlock ( underlying_t_ * mtx_p ) noexcept
+            {
+                if ( -- mtx_p -> count )
+                    return ;
+
+                mtx_p -> owner.store( 0 , std::memory_order_relaxed ) ;
+                mutex::unlock( &mtx_p -> base ) ;
+            }
+
+            static bool try_lock ( underlying_t_ * mtx_p ) noexcept
+            {
+                if ( reenter_( mtx_p ) )
+                    return true ;
+
+                if ( ! mutex::try_lock( &mtx_p -> base ) )
+                    return false ;
+
+                acquired_( mtx_p ) ;
+                return true ;
+            }
+
+            struct semantics // non copiable, non movable
+            {
+                semantics() = default ;
+                semantics( const semantics& ) = delete ;
+                semantics& operator = ( const semantics& ) = delete ;
+                protected :
+                    ~ semantics () = default ;
+            } ;
+
+            protected :
+                // only the owner can see its own tag there , so relaxed is enough
+                static bool reenter_ ( underlying_t_ * mtx_p ) noexcept
+                {
+                    if ( mtx_p -> owner.load( std::memory_order_relaxed ) != thread_tag_() )
+                        return false ;
+                    ++ mtx_p -> count ;
+                    return true ;
+                }
+
+                static void acquired_ ( underlying_t_ * mtx_p ) noexcept
+                {
+                    mtx_p -> owner.store( thread_tag_() , std::memory_order_relaxed ) ;
+                    mtx_p -> count = 1 ;
+                }
+        } ;
+
+        struct recursive_timed_mutex
+            : recursive_mutex
+        {
+            template< class Clock , class Duration >
+            static bool try_lock_until ( underlying_t_ * mtx_p , const std::chrono::time_point< Clock , Duration >& timeout_time )
+            {
+                if ( reenter_( mtx_p ) )
+                    return true ;
+
+                if ( ! timed_mutex::try_lock_until( &mtx_p -> base , timeout_time ) )
+                    return false ;
+
+                acquired_( mtx_p ) ;
+                return true ;
+            }
+
+            template< class Rep, class Period >
+            static bool try_lock_for( underlying_t_ * mtx , std::chrono::duration< Rep , Period > const& timeout_duration )
+            {
+                using namespace std::chrono ;
+                return try_lock_until( mtx , steady_clock::now() + timeout_duration ) ;
+            }
+        } ;
+    }
+}
+
+#endif // MULTI_THREAD_HXX
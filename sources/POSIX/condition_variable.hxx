@@ -7,6 +7,7 @@
 #include <type_traits>
 #include <utility>
 #include <chrono>
+#include <ctime>
 
 #include "../../mutex.hxx"
 #include <pthread.h> 
@@ -23,9 +24,19 @@ namespace multi
     {
         using native_handle_type = pthread_cond_t * ;
         
+        // deadlines are measured by CLOCK_MONOTONIC , so setting the wall clock does not stretch or cut waits
         condition_variable () 
         { 
-            if ( int err = pthread_cond_init( &cv_ , nullptr ) ) 
+            pthread_condattr_t attr ;
+            if ( int err = pthread_condattr_init( &attr ) ) 
+                throw std::system_error{ err , std::system_category() } ;
+            
+            int err = pthread_condattr_setclock( &attr , CLOCK_MONOTONIC ) ;
+            if ( ! err ) 
+                err = pthread_cond_init( &cv_ , &attr ) ;
+            
+            pthread_condattr_destroy( &attr ) ;
+            if ( err ) 
                 throw std::system_error{ err , std::system_category() } ;
         }
         
@@ -66,7 +77,7 @@ namespace multi
         cv_status wait_until( unique_lock< mutex >& lock,
                               const std::chrono::time_point< Clock , Duration >& timeout_time )
         {
-            timespec wait_until = to_sys_timepoint( timeout_time ) ;
+            timespec wait_until = to_monotonic_timespec( timeout_time ) ;
             int err = pthread_cond_timedwait( &cv_ , lock.mutex() -> native_handle() , &wait_until ) ;
             
             if ( ! err ) 
@@ -83,7 +94,7 @@ namespace multi
                               const std::chrono::time_point< Clock, Duration >& timeout_time ,
                               Predicate pred )
         {
-            timespec wait_until = to_sys_timepoint( timeout_time ) ;
+            timespec wait_until = to_monotonic_timespec( timeout_time ) ;
             while ( ! pred () ) {
                 if ( int err = pthread_cond_timedwait( &cv_ , lock.mutex() -> native_handle() , &wait_until ) ) 
                 {
@@ -96,12 +107,11 @@ namespace multi
             return true ;
         }
         
-        template< class Rep, class Duration, class Predicate >
-        bool wait_for( unique_lock< mutex >& lock,
-                       const std::chrono::duration< Rep , Duration >& duration )
+        template< class Rep, class Duration >
+        cv_status wait_for( unique_lock< mutex >& lock,
+                            const std::chrono::duration< Rep , Duration >& duration )
         {
-            return wait_until( lock , std::chrono::system_clock::now() + duration ) 
-                            == cv_status::no_timeout ;
+            return wait_until( lock , std::chrono::steady_clock::now() + duration ) ;
         }
         
         template< class Rep, class Duration, class Predicate >
@@ -109,7 +119,7 @@ namespace multi
                          const std::chrono::duration< Rep , Duration >& duration,
                          Predicate pred )
         {
-            return wait_until( lock , std::chrono::system_clock::now() + duration , std::move( pred ) ) ;
+            return wait_until( lock , std::chrono::steady_clock::now() + duration , std::move( pred ) ) ;
         }       
         
         native_handle_type native_handle () noexcept /* not const */ 
@@ -118,18 +128,22 @@ namespace multi
         }
         
         private :    
+            // the time left till src is added to CLOCK_MONOTONIC now
             template < class Clock , class Duration >
-            static timespec to_sys_timepoint ( const std::chrono::time_point< Clock, Duration >& src )
+            static timespec to_monotonic_timespec ( const std::chrono::time_point< Clock, Duration >& src )
             {
                 using namespace std::chrono ;
-                auto sys_time_point = std::is_same< Clock , system_clock >::value ? src
-                                            : system_clock::now() + ( src - Clock::now() ) ;
+                nanoseconds left = duration_cast< nanoseconds >( src - Clock::now() ) ;
+                if ( left < nanoseconds::zero() ) 
+                    left = nanoseconds::zero() ;
+                
+                timespec now ;
+                clock_gettime( CLOCK_MONOTONIC , &now ) ;
                 
-                auto duration_since_epoch = sys_time_point.time_since_epoch() ;
+                nanoseconds const since_epoch = seconds{ now.tv_sec } + nanoseconds{ now.tv_nsec } + left ;
                 
-                time_t sec = duration_cast< seconds >( duration_since_epoch ).count() ;
-                long nsec = duration_cast< nanoseconds >( duration_since_epoch 
-                                           - duration_cast< seconds >( duration_since_epoch ) ).count() ;
+                time_t sec = duration_cast< seconds >( since_epoch ).count() ;
+                long nsec = ( since_epoch - duration_cast< seconds >( since_epoch ) ).count() ;
                 
                 return { sec , nsec } ;   
             }
@@ -8,10 +8,15 @@
 #include <type_traits>
 #include <functional>
 #include <utility>
+#include <chrono>
+#include <string>
+#include <cerrno>
+#include <vector>
 
 // will be isolated somehow (excluded for all other files except this)                  //
 // do not know how to do this for now, probably with some compiler-specific features    //
 #include <pthread.h> 
+#include <sched.h>
 #include <unistd.h>
 // i will just polute gl as that is done by most of implementations //
 
@@ -29,6 +34,17 @@ namespace multi
     {
         using native_handle_type = pthread_t ;
         
+        // applied before the thread starts ; the name is set by the thread itself before it calls the function.
+        // cpus ( an affinity mask ) and name are supported on linux only.
+        struct attributes final
+        {
+            std::size_t stack_size = 0 ;   // 0 - default of the platform
+            std::string name ;             // empty - inherited ; linux keeps first 15 characters
+            std::vector< unsigned > cpus ; // empty - any cpu the process may run on
+            int policy = -1 ;              // SCHED_OTHER , SCHED_FIFO , SCHED_RR ; -1 - inherited with the priority
+            int priority = 0 ;             // sched_param::sched_priority , meaningful for the given policy
+        } ;
+        
         
         // TODO : Instances of this class may also hold the special distinct value that does not represent any thread. 
         struct id final 
@@ -99,32 +115,17 @@ namespace multi
             std::swap( obj.thread_id_ , thread_id_ ) ;
         }
         
-        template < class F , class... Args >
+        template < class F , class... Args , 
+                   class = typename std::enable_if< ! std::is_same< typename std::decay< F >::type , attributes >::value >::type >
         thread ( F&& func , Args&&... args )
         {
-            auto * caller_wrapper_p = new auto( std::bind( std::forward< F >( func ) , 
-                                                           std::forward< Args >( args )... ) ) ;
-                                                           
-            using caller_wrapper_t = typename std::remove_reference< decltype( * caller_wrapper_p ) >::type ;
-            
-            auto caller = [] ( void * ptr_to_func ) -> void *
-            { 
-                auto& caller_wrapper = * reinterpret_cast< caller_wrapper_t * >( ptr_to_func ) ;
-                
-                try { caller_wrapper() ; }
-                catch ( ... ) 
-                { 
-                    delete ( caller_wrapper_t * ) ptr_to_func ; 
-                    throw ; // terminate
-                }
-                delete ( caller_wrapper_t * ) ptr_to_func ;
-                return nullptr ;
-            } ;
-            
-            if ( int error = pthread_create( &thread_id_ , nullptr , caller , caller_wrapper_p ) ) 
-              throw std::system_error{ error , std::system_category() } ;
-            
-            is_joinable_ = true ;
+            start_( nullptr , std::forward< F >( func ) , std::forward< Args >( args )... ) ;
+        }
+        
+        template < class F , class... Args >
+        thread ( attributes const& attrs , F&& func , Args&&... args )
+        {
+            start_( &attrs , std::forward< F >( func ) , std::forward< Args >( args )... ) ;
         }
         
         ~ thread ()
@@ -160,6 +161,114 @@ namespace multi
         }
     
         private :
+            template < class Func >
+            struct caller_wrapper_
+            {
+                void operator () () 
+                {
+                    if ( ! name.empty() ) 
+                        set_name_( name ) ;
+                    func() ;
+                }
+                
+                std::string name ;
+                Func func ;
+            } ;
+            
+            template < class F , class... Args >
+            void start_ ( attributes const * attrs_p , F&& func , Args&&... args ) 
+            {
+                using bound_t = decltype( std::bind( std::forward< F >( func ) , std::forward< Args >( args )... ) ) ;
+                using caller_wrapper_t = caller_wrapper_< bound_t > ;
+                
+                auto * caller_wrapper_p = new caller_wrapper_t{ attrs_p ? attrs_p -> name : std::string{} , 
+                                                                std::bind( std::forward< F >( func ) , 
+                                                                           std::forward< Args >( args )... ) } ;
+                
+                auto caller = [] ( void * ptr_to_func ) -> void *
+                { 
+                    auto& caller_wrapper = * reinterpret_cast< caller_wrapper_t * >( ptr_to_func ) ;
+                    
+                    try { caller_wrapper() ; }
+                    catch ( ... ) 
+                    { 
+                        delete ( caller_wrapper_t * ) ptr_to_func ; 
+                        throw ; // terminate
+                    }
+                    delete ( caller_wrapper_t * ) ptr_to_func ;
+                    return nullptr ;
+                } ;
+                
+                pthread_attr_t attr ;
+                bool const has_attr = attrs_p && ( attrs_p -> stack_size || ! attrs_p -> cpus.empty() 
+                                                                         || attrs_p -> policy != -1 ) ;
+                int error = has_attr ? init_attr_( attr , * attrs_p ) : 0 ;
+                
+                if ( ! error ) {
+                    error = pthread_create( &thread_id_ , has_attr ? &attr : nullptr , caller , caller_wrapper_p ) ;
+                    if ( has_attr ) 
+                        pthread_attr_destroy( &attr ) ;
+                }
+                
+                if ( error ) {
+                    delete caller_wrapper_p ;
+                    throw std::system_error{ error , std::system_category() } ;
+                }
+                
+                is_joinable_ = true ;
+            }
+            
+            // returns an error code ; attr is destroyed on error
+            static int init_attr_ ( pthread_attr_t& attr , attributes const& attrs ) 
+            {
+                if ( int error = pthread_attr_init( &attr ) ) 
+                    return error ;
+                
+                int error = 0 ;
+                
+                if ( attrs.stack_size ) 
+                    error = pthread_attr_setstacksize( &attr , attrs.stack_size ) ;
+                
+                if ( ! error && ! attrs.cpus.empty() ) 
+                {
+                #if defined __linux__
+                    cpu_set_t cpu_set ;
+                    CPU_ZERO( &cpu_set ) ;
+                    for ( unsigned cpu : attrs.cpus ) 
+                        if ( cpu < CPU_SETSIZE ) 
+                            CPU_SET( cpu , &cpu_set ) ;
+                    error = pthread_attr_setaffinity_np( &attr , sizeof( cpu_set ) , &cpu_set ) ;
+                #else
+                    error = ENOTSUP ;
+                #endif
+                }
+                
+                if ( ! error && attrs.policy != -1 ) 
+                {
+                    sched_param param {} ;
+                    param.sched_priority = attrs.priority ;
+                    
+                    error = pthread_attr_setinheritsched( &attr , PTHREAD_EXPLICIT_SCHED ) ;
+                    if ( ! error ) error = pthread_attr_setschedpolicy( &attr , attrs.policy ) ;
+                    if ( ! error ) error = pthread_attr_setschedparam( &attr , &param ) ;
+                }
+                
+                if ( error ) 
+                    pthread_attr_destroy( &attr ) ;
+                return error ;
+            }
+            
+            static void set_name_ ( std::string const& name ) noexcept
+            {
+            #if defined __linux__
+                char truncated [ 16 ] {} ;
+                name.copy( truncated , sizeof( truncated ) - 1 ) ;
+                pthread_setname_np( pthread_self() , truncated ) ; // the name is only a hint , so an error is ignored
+            #else
+                ( void ) name ;
+            #endif
+            }
+            
             native_handle_type thread_id_ ;
             bool is_joinable_ ;
     } ;
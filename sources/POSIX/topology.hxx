@@ -0,0 +1,144 @@
+#ifndef MULTI_TOPOLOGY_IMPL_HXX
+#define MULTI_TOPOLOGY_IMPL_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// numa nodes are read from /sys/devices/system/node ( linux ) ; elsewhere , or if there is no
+// such directory , all cpus are one node. only cpus the process is allowed to run on are listed ,
+// nodes without such cpus ( e.g. memory only ones ) are skipped.
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include <sched.h>
+#include <unistd.h>
+
+namespace multi
+{
+    namespace p_
+    {
+        // "0-3,8,10-11"
+        inline std::vector< unsigned > parse_cpu_list_ ( std::string const& list )
+        {
+            std::vector< unsigned > cpus ;
+            std::istringstream ist { list } ;
+
+            for ( std::string range ; std::getline( ist , range , ',' ) ; )
+            {
+                std::istringstream range_ist { range } ;
+                unsigned first = 0 , last = 0 ;
+                char dash = 0 ;
+
+                if ( ! ( range_ist >> first ) )
+                    continue ;
+                last = ( range_ist >> dash >> last && dash == '-' ) ? last : first ;
+
+                for ( unsigned cpu = first ; cpu <= last ; ++ cpu )
+                    cpus.push_back( cpu ) ;
+            }
+            return cpus ;
+        }
+
+        inline std::string read_line_ ( std::string const& path )
+        {
+            std::ifstream ifst { path } ;
+            std::string line ;
+            std::getline( ifst , line ) ;
+            return line ;
+        }
+    }
+
+    struct cpu_topology final
+    {
+        // read once , at the first call
+        static cpu_topology const& get ()
+        {
+            static cpu_topology const topology ;
+            return topology ;
+        }
+
+        std::size_t node_count () const noexcept { return nodes_.size() ; }
+
+        std::vector< unsigned > const& node_cpus ( std::size_t const node ) const { return nodes_.at( node ) ; }
+
+        std::size_t node_of_cpu ( unsigned const cpu ) const noexcept // 0 for an unknown one
+        {
+            return cpu < cpu_nodes_.size() ? cpu_nodes_[ cpu ] : 0 ;
+        }
+
+        // a hint : the thread may be moved right after that , unless it is pinned
+        std::size_t current_node () const noexcept
+        {
+        #if defined __linux__
+            int const cpu = sched_getcpu() ;
+            return cpu < 0 ? 0 : node_of_cpu( static_cast< unsigned >( cpu ) ) ;
+        #else
+            return 0 ;
+        #endif
+        }
+
+        private :
+            cpu_topology ()
+            {
+                std::vector< unsigned > const allowed = allowed_cpus_() ;
+
+                std::string const node_dir = "/sys/devices/system/node/" ;
+                for ( unsigned node : p_::parse_cpu_list_( p_::read_line_( node_dir + "online" ) ) )
+                {
+                    std::vector< unsigned > cpus ;
+                    for ( unsigned cpu : p_::parse_cpu_list_( p_::read_line_( node_dir + "node" + std::to_string( node ) + "/cpulist" ) ) )
+                        if ( is_allowed_( allowed , cpu ) )
+                            cpus.push_back( cpu ) ;
+
+                    if ( ! cpus.empty() )
+                        nodes_.push_back( std::move( cpus ) ) ;
+                }
+
+                if ( nodes_.empty() )
+                    nodes_.push_back( allowed ) ;
+
+                for ( std::size_t node = 0 ; node < nodes_.size() ; ++ node )
+                    for ( unsigned cpu : nodes_[ node ] )
+                    {
+                        if ( cpu >= cpu_nodes_.size() )
+                            cpu_nodes_.resize( cpu + 1 , 0 ) ;
+                        cpu_nodes_[ cpu ] = node ;
+                    }
+            }
+
+            static std::vector< unsigned > allowed_cpus_ ()
+            {
+                std::vector< unsigned > cpus ;
+            #if defined __linux__
+                cpu_set_t cpu_set ;
+                if ( sched_getaffinity( 0 , sizeof( cpu_set ) , &cpu_set ) == 0 )
+                    for ( unsigned cpu = 0 ; cpu < CPU_SETSIZE ; ++ cpu )
+                        if ( CPU_ISSET( cpu , &cpu_set ) )
+                            cpus.push_back( cpu ) ;
+            #endif
+                if ( cpus.empty() )
+                {
+                    long const online = sysconf( _SC_NPROCESSORS_ONLN ) ;
+                    for ( unsigned cpu = 0 ; cpu < static_cast< unsigned >( online > 0 ? online : 1 ) ; ++ cpu )
+                        cpus.push_back( cpu ) ;
+                }
+                return cpus ;
+            }
+
+            static bool is_allowed_ ( std::vector< unsigned > const& allowed , unsigned const cpu )
+            {
+                for ( unsigned each : allowed )
+                    if ( each == cpu )
+                        return true ;
+                return false ;
+            }
+
+            std::vector< std::vector< unsigned > > nodes_ ; // cpus of every node
+            std::vector< std::size_t > cpu_nodes_ ;         // node of every cpu
+    } ;
+}
+
+#endif // MULTI_TOPOLOGY_IMPL_HXX
@@ -8,6 +8,8 @@
 #include <type_traits>
 #include <functional>
 #include <utility>
+#include <string>
+#include <vector>
 
 // will be isolated somehow (excluded for all other files except this)                  //
 // do not know how to do this for now, probably with some compiler-specific features    //
@@ -27,6 +29,17 @@ namespace multi
     {
         using native_handle_type = HANDLE ;
         
+        // the thread is created suspended and resumed after the attributes are applied.
+        // name is not supported ; priority is one of THREAD_PRIORITY_* and is set if policy != -1.
+        struct attributes final
+        {
+            std::size_t stack_size = 0 ;   // 0 - default of the platform
+            std::string name ;             // ignored
+            std::vector< unsigned > cpus ; // empty - any ; only the first 64 cpus ( one processor group )
+            int policy = -1 ;              // -1 - the priority is not set
+            int priority = 0 ;             
+        } ;
+        
         
         // TODO : Instances of this class may also hold the special distinct value that does not represent any thread. 
         struct id final 
@@ -94,36 +107,17 @@ namespace multi
             std::swap( obj.handle_ , handle_ ) ;
         }
         
-        template < class F , class... Args >
+        template < class F , class... Args , 
+                   class = typename std::enable_if< ! std::is_same< typename std::decay< F >::type , attributes >::value >::type >
         thread ( F&& func , Args&&... args )
         {
-            auto * caller_wrapper_p = new auto( std::bind( std::forward< F >( func ) , 
-                                                           std::forward< Args >( args )... ) ) ;
-                                                           
-            using caller_wrapper_t = typename std::remove_reference< decltype( * caller_wrapper_p ) >::type ;
-            
-            DWORD ( * caller )( LPVOID ) = [] ( LPVOID ptr_to_func ) -> DWORD 
-            { 
-                auto& caller_wrapper = * reinterpret_cast< caller_wrapper_t * >( ptr_to_func ) ;
-                
-                try { caller_wrapper() ; }
-                catch ( ... ) 
-                { 
-                    delete ( caller_wrapper_t * ) ptr_to_func ; 
-                    throw ; // terminate
-                }
-                delete ( caller_wrapper_t * ) ptr_to_func ;
-                return 0 ;
-            } ;
-            
-            id::underlying_t_ thread_id ;
-            
-            handle_ = CreateThread( nullptr , 0 , ( LPTHREAD_START_ROUTINE ) caller, caller_wrapper_p , 0 , &thread_id ) ;
-            
-            if ( ! handle_ ) 
-              throw std::system_error{ ( int ) GetLastError() , std::system_category() } ;
-            
-            id_ = id( thread_id ) ;
+            start_( nullptr , std::forward< F >( func ) , std::forward< Args >( args )... ) ;
+        }
+        
+        template < class F , class... Args >
+        thread ( attributes const& attrs , F&& func , Args&&... args )
+        {
+            start_( &attrs , std::forward< F >( func ) , std::forward< Args >( args )... ) ;
         }
         
         ~ thread ()
@@ -161,6 +155,73 @@ namespace multi
         }
     
         private :
+            template < class F , class... Args >
+            void start_ ( attributes const * attrs_p , F&& func , Args&&... args ) 
+            {
+                auto * caller_wrapper_p = new auto( std::bind( std::forward< F >( func ) , 
+                                                               std::forward< Args >( args )... ) ) ;
+                                                               
+                using caller_wrapper_t = typename std::remove_reference< decltype( * caller_wrapper_p ) >::type ;
+                
+                DWORD ( * caller )( LPVOID ) = [] ( LPVOID ptr_to_func ) -> DWORD 
+                { 
+                    auto& caller_wrapper = * reinterpret_cast< caller_wrapper_t * >( ptr_to_func ) ;
+                    
+                    try { caller_wrapper() ; }
+                    catch ( ... ) 
+                    { 
+                        delete ( caller_wrapper_t * ) ptr_to_func ; 
+                        throw ; // terminate
+                    }
+                    delete ( caller_wrapper_t * ) ptr_to_func ;
+                    return 0 ;
+                } ;
+                
+                bool const is_suspended = attrs_p && ( ! attrs_p -> cpus.empty() || attrs_p -> policy != -1 ) ;
+                
+                id::underlying_t_ thread_id ;
+                
+                handle_ = CreateThread( nullptr , attrs_p ? attrs_p -> stack_size : 0 , 
+                                        ( LPTHREAD_START_ROUTINE ) caller, caller_wrapper_p , 
+                                        is_suspended ? CREATE_SUSPENDED : 0 , &thread_id ) ;
+                
+                if ( ! handle_ ) {
+                    delete caller_wrapper_p ;
+                    throw std::system_error{ ( int ) GetLastError() , std::system_category() } ;
+                }
+                
+                if ( is_suspended && ! apply_( handle_ , * attrs_p ) ) 
+                {
+                    DWORD const error = GetLastError() ;
+                    TerminateThread( handle_ , 0 ) ; // it has not run anything yet
+                    CloseHandle( handle_ ) ;
+                    handle_ = nullptr ;
+                    delete caller_wrapper_p ;
+                    throw std::system_error{ ( int ) error , std::system_category() } ;
+                }
+                
+                id_ = id( thread_id ) ;
+                
+                if ( is_suspended ) 
+                    ResumeThread( handle_ ) ;
+            }
+            
+            static bool apply_ ( native_handle_type handle , attributes const& attrs ) noexcept
+            {
+                if ( ! attrs.cpus.empty() ) 
+                {
+                    DWORD_PTR mask = 0 ;
+                    for ( unsigned cpu : attrs.cpus ) 
+                        if ( cpu < sizeof( mask ) * 8 ) 
+                            mask |= DWORD_PTR( 1 ) << cpu ;
+                    
+                    if ( ! SetThreadAffinityMask( handle , mask ) ) 
+                        return false ;
+                }
+                
+                return attrs.policy == -1 || SetThreadPriority( handle , attrs.priority ) ;
+            }
+            
             native_handle_type handle_ ;
             id id_ ;
     } ;
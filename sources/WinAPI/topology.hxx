@@ -0,0 +1,82 @@
+#ifndef MULTI_TOPOLOGY_IMPL_HXX
+#define MULTI_TOPOLOGY_IMPL_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// only the first processor group ( 64 cpus ) is taken into account , as thread::attributes::cpus
+
+#include <vector>
+#include <cstddef>
+
+#include <windows.h>
+
+namespace multi
+{
+    struct cpu_topology final
+    {
+        // read once , at the first call
+        static cpu_topology const& get ()
+        {
+            static cpu_topology const topology ;
+            return topology ;
+        }
+
+        std::size_t node_count () const noexcept { return nodes_.size() ; }
+
+        std::vector< unsigned > const& node_cpus ( std::size_t const node ) const { return nodes_.at( node ) ; }
+
+        std::size_t node_of_cpu ( unsigned const cpu ) const noexcept // 0 for an unknown one
+        {
+            return cpu < cpu_nodes_.size() ? cpu_nodes_[ cpu ] : 0 ;
+        }
+
+        // a hint : the thread may be moved right after that , unless it is pinned
+        std::size_t current_node () const noexcept
+        {
+            return node_of_cpu( GetCurrentProcessorNumber() ) ;
+        }
+
+        private :
+            cpu_topology ()
+            {
+                DWORD_PTR process_mask = 0 , system_mask = 0 ;
+                if ( ! GetProcessAffinityMask( GetCurrentProcess() , &process_mask , &system_mask ) )
+                    process_mask = 1 ;
+
+                ULONG highest = 0 ;
+                if ( ! GetNumaHighestNodeNumber( &highest ) )
+                    highest = 0 ;
+
+                for ( ULONG node = 0 ; node <= highest ; ++ node )
+                {
+                    ULONGLONG node_mask = 0 ;
+                    if ( ! GetNumaNodeProcessorMask( static_cast< UCHAR >( node ) , &node_mask ) )
+                        node_mask = highest ? 0 : process_mask ;
+
+                    std::vector< unsigned > cpus ;
+                    for ( unsigned cpu = 0 ; cpu < sizeof( DWORD_PTR ) * 8 ; ++ cpu )
+                        if ( ( node_mask & process_mask ) & ( ULONGLONG( 1 ) << cpu ) )
+                            cpus.push_back( cpu ) ;
+
+                    if ( ! cpus.empty() )
+                        nodes_.push_back( std::move( cpus ) ) ;
+                }
+
+                if ( nodes_.empty() )
+                    nodes_.push_back( std::vector< unsigned >{ 0 } ) ;
+
+                for ( std::size_t node = 0 ; node < nodes_.size() ; ++ node )
+                    for ( unsigned cpu : nodes_[ node ] )
+                    {
+                        if ( cpu >= cpu_nodes_.size() )
+                            cpu_nodes_.resize( cpu + 1 , 0 ) ;
+                        cpu_nodes_[ cpu ] = node ;
+                    }
+            }
+
+            std::vector< std::vector< unsigned > > nodes_ ; // cpus of every node
+            std::vector< std::size_t > cpu_nodes_ ;         // node of every cpu
+    } ;
+}
+
+#endif // MULTI_TOPOLOGY_IMPL_HXX
@@ -0,0 +1,233 @@
+#ifndef MULTI_TASK_HXX
+#define MULTI_TASK_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// move-only void() callable ; a callable that fits into Capacity bytes ( and is nothrow movable )
+// is kept inline , so constructing / moving / destroying such task never touches the allocator.
+// bigger ones are kept on the heap , as std::function does.
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <stdexcept>
+
+namespace multi
+{
+    namespace p_
+    {
+        template < class... >
+        struct voider { using type = void ; } ;
+
+        // F& can be called with no arguments , as the task calls it
+        template < class F , class = void >
+        struct is_callable : std::false_type { } ;
+
+        template < class F >
+        struct is_callable< F , typename voider< decltype( std::declval< F& >()() ) >::type > : std::true_type { } ;
+
+        // null function pointers and empty std::function make an empty task , as they make an empty std::function
+        template < class F >
+        bool is_null_callable ( F const& func , typename std::enable_if< std::is_pointer< F >::value >::type * = nullptr ) noexcept
+        {
+            return func == nullptr ;
+        }
+
+        template < class F >
+        bool is_null_callable ( F const& , typename std::enable_if< ! std::is_pointer< F >::value >::type * = nullptr ) noexcept
+        {
+            return false ;
+        }
+
+        template < class Signature >
+        bool is_null_callable ( std::function< Signature > const& func ) noexcept
+        {
+            return ! func ;
+        }
+    }
+
+    constexpr std::size_t default_task_capacity = 6 * sizeof( void * ) ; // with the ops pointer and padding , 64 bytes on x86-64
+
+    template < std::size_t Capacity = default_task_capacity >
+    struct basic_task final
+    {
+        static constexpr std::size_t capacity = Capacity ;
+
+        template < class F >
+        struct is_inline
+            : std::integral_constant< bool , sizeof( F ) <= Capacity
+                                             && alignof( std::max_align_t ) % alignof( F ) == 0
+                                             && std::is_nothrow_move_constructible< F >::value >
+        {
+        } ;
+
+        basic_task () noexcept : ops_{ nullptr } { }
+
+        basic_task ( std::nullptr_t ) noexcept : ops_{ nullptr } { }
+
+        template < class F ,
+                   class Func = typename std::decay< F >::type ,
+                   class = typename std::enable_if< ! std::is_same< Func , basic_task >::value
+                                                    && p_::is_callable< Func >::value >::type >
+        basic_task ( F&& func ) noexcept( is_inline< Func >::value
+                                          && std::is_nothrow_constructible< Func , F&& >::value )
+            : ops_{ nullptr }
+        {
+            if ( ! p_::is_null_callable( func ) )
+                construct_< Func >( is_inline< Func >{} , std::forward< F >( func ) ) ;
+        }
+
+        // arguments are bound as by std::bind ; lets queues emplace a task from ( func , args... )
+        template < class F , class Arg0 , class... Args >
+        basic_task ( F&& func , Arg0&& arg0 , Args&&... args )
+            : basic_task( std::bind( std::forward< F >( func ) ,
+                                     std::forward< Arg0 >( arg0 ) ,
+                                     std::forward< Args >( args )... ) )
+        {
+        }
+
+        basic_task ( basic_task const& ) = delete ;
+        basic_task& operator = ( basic_task const& ) = delete ;
+
+        basic_task ( basic_task&& src ) noexcept
+            : ops_{ src.ops_ }
+        {
+            if ( ops_ ) {
+                ops_ -> move( &storage_ , &src.storage_ ) ;
+                src.ops_ = nullptr ;
+            }
+        }
+
+        basic_task& operator = ( basic_task&& src ) noexcept
+        {
+            if ( this != &src ) {
+                reset_() ;
+                if ( src.ops_ ) {
+                    src.ops_ -> move( &storage_ , &src.storage_ ) ;
+                    ops_ = src.ops_ ;
+                    src.ops_ = nullptr ;
+                }
+            }
+            return * this ;
+        }
+
+        basic_task& operator = ( std::nullptr_t ) noexcept
+        {
+            reset_() ;
+            return * this ;
+        }
+
+        ~ basic_task () { reset_() ; }
+
+        void operator () ()
+        {
+            if ( ! ops_ )
+                throw std::bad_function_call{} ;
+            ops_ -> invoke( &storage_ ) ;
+        }
+
+        explicit operator bool () const noexcept { return ops_ != nullptr ; }
+
+        void swap ( basic_task& obj ) noexcept
+        {
+            basic_task tmp { std::move( obj ) } ;
+            obj = std::move( * this ) ;
+            * this = std::move( tmp ) ;
+        }
+
+        private :
+            using storage_t_ = typename std::aligned_storage< Capacity , alignof( std::max_align_t ) >::type ;
+
+            struct ops_t_
+            {
+                void ( * invoke ) ( storage_t_ * ) ;
+                void ( * move ) ( storage_t_ * dst , storage_t_ * src ) noexcept ; // src is destroyed
+                void ( * destroy ) ( storage_t_ * ) noexcept ;
+            } ;
+
+            template < class Func >
+            struct inline_ops_
+            {
+                static Func * get ( storage_t_ * ptr ) noexcept { return reinterpret_cast< Func * >( ptr ) ; }
+
+                static void invoke ( storage_t_ * ptr ) { ( * get( ptr ) )() ; }
+
+                static void move ( storage_t_ * dst , storage_t_ * src ) noexcept
+                {
+                    ::new ( dst ) Func( std::move( * get( src ) ) ) ;
+                    get( src ) -> ~ Func() ;
+                }
+
+                static void destroy ( storage_t_ * ptr ) noexcept { get( ptr ) -> ~ Func() ; }
+
+                static constexpr ops_t_ ops { &invoke , &move , &destroy } ;
+            } ;
+
+            template < class Func >
+            struct heap_ops_
+            {
+                static Func *& get ( storage_t_ * ptr ) noexcept { return * reinterpret_cast< Func ** >( ptr ) ; }
+
+                static void invoke ( storage_t_ * ptr ) { ( * get( ptr ) )() ; }
+
+                static void move ( storage_t_ * dst , storage_t_ * src ) noexcept
+                {
+                    ::new ( dst ) Func * ( get( src ) ) ;
+                }
+
+                static void destroy ( storage_t_ * ptr ) noexcept { delete get( ptr ) ; }
+
+                static constexpr ops_t_ ops { &invoke , &move , &destroy } ;
+            } ;
+
+            template < class Func , class F >
+            void construct_ ( std::true_type , F&& func )
+            {
+                ::new ( &storage_ ) Func( std::forward< F >( func ) ) ;
+                ops_ = &inline_ops_< Func >::ops ;
+            }
+
+            template < class Func , class F >
+            void construct_ ( std::false_type , F&& func )
+            {
+                static_assert( sizeof( Func * ) <= Capacity , "basic_task capacity is less than a pointer" ) ;
+
+                ::new ( &storage_ ) Func * ( new Func( std::forward< F >( func ) ) ) ;
+                ops_ = &heap_ops_< Func >::ops ;
+            }
+
+            void reset_ () noexcept
+            {
+                if ( ops_ ) {
+                    ops_ -> destroy( &storage_ ) ;
+                    ops_ = nullptr ;
+                }
+            }
+
+            ops_t_ const * ops_ ;
+            storage_t_ storage_ ;
+    } ;
+
+    template < std::size_t Capacity >
+    constexpr std::size_t basic_task< Capacity >::capacity ;
+
+    template < std::size_t Capacity >
+    template < class Func >
+    constexpr typename basic_task< Capacity >::ops_t_ basic_task< Capacity >::inline_ops_< Func >::ops ;
+
+    template < std::size_t Capacity >
+    template < class Func >
+    constexpr typename basic_task< Capacity >::ops_t_ basic_task< Capacity >::heap_ops_< Func >::ops ;
+
+    using task = basic_task<> ;
+
+    template < std::size_t Capacity >
+    void swap ( basic_task< Capacity >& op0 , basic_task< Capacity >& op1 ) noexcept
+    {
+        op0.swap( op1 ) ;
+    }
+}
+
+#endif // MULTI_TASK_HXX
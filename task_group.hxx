@@ -0,0 +1,195 @@
+#ifndef MULTI_TASK_GROUP_HXX
+#define MULTI_TASK_GROUP_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// tasks run through a group are counted apart from the rest of the pool , so wait () returns
+// as soon as they are done , while pool.join () waits for everybody's tasks.
+// the waiting thread runs queued tasks of the pool meanwhile , so a task of the pool may wait
+// for the tasks it has spawned ( fork / join ) without taking a thread away from them.
+
+#include <exception>
+#include <utility>
+#include <atomic>
+#include <functional>
+
+#include "mutex.hxx"
+#include "condition_variable.hxx"
+#include "future.hxx"
+#include "thread_pool.hxx"
+
+namespace multi
+{
+    // Pool : thread_pool whose task_type is constructible from a callable ( std::function , multi::task , etc. )
+    template < class Pool >
+    struct task_group final
+    {
+        using pool_type = Pool ;
+
+        explicit task_group ( pool_type& pool ) noexcept
+            : pool_( pool ) , pending_{ 0 } , enqueued_{ 0 } , waiters_{ 0 }
+        {
+        }
+
+        task_group ( task_group const& ) = delete ;
+        task_group& operator = ( task_group const& ) = delete ;
+
+        // the tasks refer to the group , so it waits for them ; an exception is lost then
+        ~ task_group ()
+        {
+            try { wait() ; }
+            catch ( ... ) { }
+        }
+
+        // one allocation per task , as thread_pool::submit.
+        // a task that is discarded from the queue counts as done with future_errc::broken_promise.
+        // when a bounded queue of the pool is full , the task is run right here instead of waiting for a cell :
+        // the threads that could free one may be waiting for this group.
+        template < class F , class... Args >
+        void run ( F&& func , Args&&... args )
+        {
+            using bound_type = p_::bound_t< F , Args... > ;
+
+            runner_< bound_type > runner { new node_< bound_type >(
+                    * this , bound_type( std::forward< F >( func ) , std::forward< Args >( args )... ) ) } ;
+
+            ++ pending_ ;
+            if ( pool_.enqueue_or_run( typename pool_type::task_type( std::move( runner ) ) ) ) // pending_ is decremented by the runner on failure
+                announce_() ;
+        }
+
+        // rethrows the first exception thrown by a task of the group since the last wait ()
+        void wait ()
+        {
+            while ( pending_.load() )
+            {
+                std::size_t const enqueued = enqueued_.load() ; // before the pop , see announce_
+                if ( pool_.run_pending_task() )
+                    continue ;
+
+                // woken when the group is done or has got a new task in the queue to help with
+                unique_lock< mutex > lock { mtx_ } ;
+                ++ waiters_ ;
+                auto leave = p_::make_guard( [ this ] () { -- waiters_ ; } ) ;
+                cv_.wait( lock , [ this , enqueued ] () {
+                    return pending_.load() == 0 || enqueued_.load() != enqueued ;
+                } ) ;
+            }
+
+            std::exception_ptr error ;
+            {
+                lock_guard< mutex > lock { mtx_ } ; // the last done_ () may still hold it
+                std::swap( error , error_ ) ;
+            }
+
+            if ( error )
+                std::rethrow_exception( error ) ;
+        }
+
+        bool is_done () const noexcept
+        {
+            return pending_.load() == 0 ;
+        }
+
+        private :
+            template < class Func >
+            struct node_
+            {
+                node_ ( task_group& group , Func func )
+                    : refs{ 1 } , group( group ) , func( std::move( func ) ) , is_run{ false }
+                {
+                }
+
+                std::atomic< unsigned > refs ;
+                task_group& group ;
+                Func func ;
+                bool is_run ; // only one of the copies is executed
+            } ;
+
+            // what is actually enqueued ; copies share the node , as p_::task_runner does
+            template < class Func >
+            struct runner_
+            {
+                explicit runner_ ( node_< Func > * node ) noexcept : node_p_{ node } { }
+
+                runner_ ( runner_ const& src ) noexcept
+                    : node_p_{ src.node_p_ }
+                {
+                    if ( node_p_ ) ++ node_p_ -> refs ;
+                }
+
+                runner_ ( runner_&& src ) noexcept
+                    : node_p_{ src.node_p_ }
+                {
+                    src.node_p_ = nullptr ;
+                }
+
+                runner_& operator = ( runner_ src ) noexcept
+                {
+                    std::swap( node_p_ , src.node_p_ ) ;
+                    return * this ;
+                }
+
+                ~ runner_ ()
+                {
+                    if ( ! node_p_ || node_p_ -> refs.fetch_sub( 1 , std::memory_order_acq_rel ) != 1 )
+                        return ;
+
+                    if ( ! node_p_ -> is_run )
+                        node_p_ -> group.done_( std::make_exception_ptr( future_error{ future_errc::broken_promise } ) ) ;
+                    delete node_p_ ;
+                }
+
+                void operator () ()
+                {
+                    node_< Func > * const node = node_p_ ;
+                    if ( node -> is_run )
+                        return ;
+                    node -> is_run = true ;
+
+                    std::exception_ptr error ;
+                    try { node -> func() ; }
+                    catch ( ... ) { error = std::current_exception() ; }
+
+                    node -> group.done_( std::move( error ) ) ; // the group may be gone after that
+                }
+
+                private :
+                    node_< Func > * node_p_ ;
+            } ;
+
+            // the same handshake as thread_pool::sleeping_count_ : either the waiter sees the new count , 
+            // or this sees the waiter and notifies it under mtx_
+            void announce_ ()
+            {
+                ++ enqueued_ ;
+                if ( waiters_.load() ) {
+                    lock_guard< mutex > lock { mtx_ } ;
+                    cv_.notify_all() ;
+                }
+            }
+
+            void done_ ( std::exception_ptr error ) noexcept
+            {
+                lock_guard< mutex > lock { mtx_ } ;
+
+                if ( error && ! error_ )
+                    error_ = std::move( error ) ;
+
+                if ( pending_.fetch_sub( 1 ) == 1 )
+                    cv_.notify_all() ;
+            }
+
+            pool_type& pool_ ;
+            std::atomic< std::size_t > pending_ ;
+            std::atomic< std::size_t > enqueued_ ; // tasks of the group put into the queue
+            std::atomic< std::size_t > waiters_ ;  // mtx_ to increase ; threads in wait () that are about to wait / waiting on cv_
+
+            mutex mtx_ ;
+            condition_variable cv_ ; // mtx_ ; waiters of wait () , when there is nothing to help with
+            std::exception_ptr error_ ; // mtx_
+    } ;
+
+}
+
+#endif // MULTI_TASK_GROUP_HXX
@@ -0,0 +1,129 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM batch_enqueue.cxx -lpthread
+#include <iostream>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../mpmc_queue.hxx"
+#include "../work_stealing_queue.hxx"
+
+template < class Pool >
+void enqueue_range ( Pool& pool , std::atomic< std::size_t >& count_times , std::size_t const times )
+{
+    std::vector< typename Pool::task_type > tasks ;
+    for ( std::size_t count = 0 ; count < times ; ++ count )
+        tasks.emplace_back( [ &count_times ] () { ++ count_times ; } ) ;
+
+    auto it = tasks.begin() ;
+    pool.enqueue( it , tasks.end() ) ;
+    assert( it == tasks.end() ) ;
+}
+
+int main ()
+{
+    using namespace std::chrono ;
+    using function_queue = std::queue< std::function< void() > > ;
+
+    std::atomic< std::size_t > count_times { 0 } ;
+
+    { // several tasks per lock ; the not started ones go back to the queue on pause
+        multi::thread_pool< function_queue > pool{ 4 } ;
+        pool.set_dequeue_batch( 16 ) ;
+
+        enqueue_range( pool , count_times , 10000 ) ;
+        pool.join() ;
+        assert( count_times == 10000 ) ;
+
+        pool.pause() ;
+        enqueue_range( pool , count_times , 1000 ) ;
+        multi::this_thread::sleep_for( milliseconds{ 50 } ) ;
+        assert( count_times == 10000 ) ;
+
+        pool.resume() ;
+        pool.join() ;
+        assert( count_times == 11000 ) ;
+
+        pool.remove_thread() ;
+        pool.remove_thread() ;
+        enqueue_range( pool , count_times , 1000 ) ;
+        pool.join() ;
+        assert( count_times == 12000 ) ;
+
+        bool thrown = false ;
+        try { pool.set_dequeue_batch( 0 ) ; }
+        catch ( std::invalid_argument const& ) { thrown = true ; }
+        assert( thrown ) ;
+    }
+
+    { // pause while a batch runs : the rest of it goes back to the queue , or is dropped by discard_queue ()
+        multi::thread_pool< function_queue > pool{ 1 } ;
+        pool.set_dequeue_batch( 16 ) ;
+
+        std::vector< std::size_t > order ;
+        std::atomic< bool > is_started { false } , is_released { false } ;
+
+        auto take_batch = [ & ] () { // the worker takes the first task and 15 more at once
+            is_started = false ;
+            is_released = false ;
+            pool.pause() ;
+
+            std::vector< std::function< void() > > tasks ;
+            tasks.emplace_back( [ & ] () {
+                is_started = true ;
+                while ( ! is_released )
+                    multi::this_thread::yield() ;
+            } ) ;
+            for ( std::size_t index = 1 ; index < 16 ; ++ index )
+                tasks.emplace_back( [ &order , index ] () { order.push_back( index ) ; } ) ;
+
+            auto it = tasks.begin() ;
+            pool.enqueue( it , tasks.end() ) ;
+            pool.resume() ;
+            while ( ! is_started )
+                multi::this_thread::yield() ;
+            pool.pause() ;
+        } ;
+
+        take_batch() ;
+        pool.enqueue( [ &order ] () { order.push_back( 100 ) ; } ) ;
+        is_released = true ;
+        multi::this_thread::sleep_for( milliseconds{ 50 } ) ;
+        assert( order.empty() ) ;
+
+        pool.resume() ;
+        pool.join() ;
+        assert( order.size() == 16 && order.front() == 100 && order.back() == 15 ) ; // put back behind the queued one
+
+        order.clear() ;
+        take_batch() ;
+        pool.discard_queue() ;
+        pool.enqueue( [ &order ] () { order.push_back( 100 ) ; } ) ;
+        is_released = true ;
+
+        pool.resume() ;
+        pool.join() ;
+        assert( ( order == std::vector< std::size_t >{ 100 } ) ) ;
+    }
+
+    { // a range that does not fit into a bounded queue : workers are woken before the producer parks
+        multi::thread_pool< multi::mpmc_queue< std::function< void() > > > pool{ 2 , {} , 16 } ;
+
+        enqueue_range( pool , count_times , 10000 ) ;
+        pool.join() ;
+        assert( count_times == 22000 ) ;
+    }
+
+    {
+        multi::thread_pool< multi::work_stealing_queue< std::function< void() > > > pool{ 4 } ;
+
+        for ( std::size_t count = 0 ; count < 100 ; ++ count )
+            enqueue_range( pool , count_times , 100 ) ;
+        pool.join() ;
+        assert( count_times == 32000 ) ;
+    }
+
+    std::cerr << "bue" ;
+}
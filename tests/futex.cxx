@@ -0,0 +1,101 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_LINUX_FUTEX_PLATFORM futex.cxx -lpthread
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM futex.cxx -lpthread
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cassert>
+
+#include "../condition_variable.hxx"
+#include "../thread.hxx"
+#include "../mutex.hxx"
+
+int main ()
+{
+    using namespace std::chrono ;
+    namespace ns = multi ;
+
+    { // contended counter
+        ns::mutex mtx ;
+        std::size_t counter = 0 ;
+
+        std::vector< ns::thread > threads ;
+        for ( std::size_t count = 0 ; count < 8 ; ++ count )
+            threads.emplace_back( [ &mtx , &counter ] () {
+                for ( std::size_t count = 0 ; count < 100000 ; ++ count ) {
+                    ns::lock_guard< ns::mutex > lock { mtx } ;
+                    ++ counter ;
+                }
+            } ) ;
+
+        for ( auto& each : threads )
+            each.join() ;
+
+        assert( counter == 800000 ) ;
+        assert( mtx.try_lock() ) ;
+        assert( ! mtx.try_lock() ) ;
+        mtx.unlock() ;
+    }
+
+    { // recursive and timed
+        ns::recursive_timed_mutex mtx ;
+        ns::unique_lock< ns::recursive_timed_mutex > lock { mtx } ;
+        assert( mtx.try_lock() ) ;
+        mtx.unlock() ;
+
+        bool locked = true ;
+        steady_clock::time_point started ;
+        steady_clock::time_point finished ;
+
+        ns::thread other( [ & ] () {
+            started = steady_clock::now() ;
+            locked = mtx.try_lock_for( milliseconds{ 100 } ) ;
+            finished = steady_clock::now() ;
+        } ) ;
+        other.join() ;
+
+        assert( ! locked ) ;
+        assert( finished - started >= milliseconds{ 100 } ) ;
+    }
+
+    { // ping - pong
+        ns::mutex mtx ;
+        ns::condition_variable cv ;
+        std::size_t turn = 0 ;
+        std::size_t const rounds = 10000 ;
+
+        auto player = [ & ] ( std::size_t const me ) {
+            for ( std::size_t count = 0 ; count < rounds ; ++ count ) {
+                ns::unique_lock< ns::mutex > lock { mtx } ;
+                cv.wait( lock , [ & ] () { return turn % 2 == me ; } ) ;
+                ++ turn ;
+                cv.notify_one() ;
+            }
+        } ;
+
+        ns::thread ping { player , 0 } , pong { player , 1 } ;
+        ping.join() ;
+        pong.join() ;
+
+        assert( turn == 2 * rounds ) ;
+    }
+
+    { // timeout is measured by a monotonic clock
+        ns::mutex mtx ;
+        ns::condition_variable cv ;
+        ns::unique_lock< ns::mutex > lock { mtx } ;
+
+        auto const started = steady_clock::now() ;
+        assert( cv.wait_for( lock , milliseconds{ 50 } ) == ns::cv_status::timeout ) ;
+        assert( ! cv.wait_for( lock , milliseconds{ 50 } , [] () { return false ; } ) ) ;
+        assert( steady_clock::now() - started >= milliseconds{ 100 } ) ;
+        assert( lock ) ;
+
+        // a deadline of another clock is waited for as the time left till it
+        auto const sys_started = steady_clock::now() ;
+        assert( cv.wait_until( lock , system_clock::now() + milliseconds{ 50 } ) == ns::cv_status::timeout ) ;
+        assert( steady_clock::now() - sys_started >= milliseconds{ 45 } ) ;
+        assert( cv.wait_until( lock , steady_clock::now() - milliseconds{ 1 } ) == ns::cv_status::timeout ) ;
+    }
+
+    std::cerr << "bue" ;
+}
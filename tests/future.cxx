@@ -0,0 +1,98 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM future.cxx -lpthread
+#include <iostream>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../future.hxx"
+#include "../work_stealing_queue.hxx"
+
+int main ()
+{
+    using namespace std::chrono ;
+
+    { // promise / future between two threads
+        multi::promise< std::string > promise ;
+        multi::future< std::string > future = promise.get_future() ;
+
+        try { promise.get_future() ; assert( false ) ; }
+        catch ( multi::future_error const& e ) {
+            assert( e.code() == multi::future_errc::future_already_retrieved ) ;
+        }
+
+        assert( future.wait_for( milliseconds{ 10 } ) == multi::future_status::timeout ) ;
+
+        multi::thread setter( [ &promise ] () {
+            multi::this_thread::sleep_for( milliseconds{ 50 } ) ;
+            promise.set_value( "hi" ) ;
+        } ) ;
+
+        assert( future.get() == "hi" ) ;
+        assert( ! future.valid() ) ;
+        setter.join() ;
+    }
+
+    { // broken promise
+        multi::future< void > future ;
+        {
+            multi::promise< void > promise ;
+            future = promise.get_future() ;
+        }
+        try { future.get() ; assert( false ) ; }
+        catch ( multi::future_error const& e ) {
+            assert( e.code() == multi::future_errc::broken_promise ) ;
+        }
+    }
+
+    multi::thread_pool< std::queue< std::function< void() > > > pool{ 4 } ;
+
+    // results and exceptions come back through the futures , no pool.join () is needed
+    std::vector< multi::future< std::size_t > > squares ;
+    for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+        squares.push_back( pool.submit( [] ( std::size_t value ) { return value * value ; } , count ) ) ;
+
+    for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+        assert( squares[ count ].get() == count * count ) ;
+
+    multi::future< void > failed = pool.submit( [] () { throw std::runtime_error{ "expected" } ; } ) ;
+    try { failed.get() ; assert( false ) ; }
+    catch ( std::runtime_error const& e ) {
+        std::cerr << "\ncaught : " << e.what() ;
+    }
+
+    // move-only arguments are moved into the task and on into func
+    multi::future< int > moved = pool.submit( [] ( std::unique_ptr< int > ptr ) { return * ptr ; } , 
+                                              std::unique_ptr< int >( new int{ 3 } ) ) ;
+    assert( moved.get() == 3 ) ;
+
+    // std::bind placeholders are plain arguments , not bound ones
+    auto placeholder = std::placeholders::_1 ;
+    multi::future< bool > plain = pool.submit( [] ( decltype( placeholder ) ) { return true ; } , placeholder ) ;
+    assert( plain.get() ) ;
+
+    // a pointer to member is called on the object that follows it
+    std::string const text{ "four" } ;
+    assert( pool.submit( &std::string::size , &text ).get() == 4 ) ;
+
+    int value = 0 ;
+    multi::future< int& > ref = pool.submit( [ &value ] () -> int& { return value ; } ) ;
+    assert( &ref.get() == &value ) ;
+
+    // discarded task breaks the promise
+    multi::thread_pool< multi::work_stealing_queue< std::function< void() > > > paused_pool{ 2 } ;
+    paused_pool.pause() ;
+    multi::future< void > discarded = paused_pool.submit( [] () { } ) ;
+    assert( discarded.wait_for( milliseconds{ 10 } ) == multi::future_status::timeout ) ;
+    paused_pool.discard_queue() ;
+    try { discarded.get() ; assert( false ) ; }
+    catch ( multi::future_error const& e ) {
+        assert( e.code() == multi::future_errc::broken_promise ) ;
+    }
+
+    std::cerr << "\nbue" ;
+}
@@ -0,0 +1,178 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM mpmc_queue.cxx -lpthread
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../mpmc_queue.hxx"
+
+int main ()
+{
+    using namespace std::chrono ;
+
+    { // raw queue : every produced value is consumed exactly once
+        multi::mpmc_queue< std::size_t > queue{ 100 } ;
+        assert( queue.capacity() == 128 ) ;
+        assert( queue.empty() ) ;
+
+        std::size_t const per_producer = 100000 ;
+        std::atomic< std::size_t > consumed_sum { 0 } , consumed_count { 0 } ;
+
+        std::vector< multi::thread > threads ;
+        for ( std::size_t producer = 0 ; producer < 2 ; ++ producer )
+            threads.emplace_back( [ & ] () {
+                for ( std::size_t value = 1 ; value <= per_producer ; ++ value )
+                    while ( ! queue.try_push( value ) )
+                        multi::this_thread::yield() ;
+            } ) ;
+
+        for ( std::size_t consumer = 0 ; consumer < 2 ; ++ consumer )
+            threads.emplace_back( [ & ] () {
+                std::size_t value ;
+                while ( consumed_count.load() != 2 * per_producer )
+                    if ( queue.try_pop( value ) ) {
+                        consumed_sum += value ;
+                        ++ consumed_count ;
+                    }
+            } ) ;
+
+        for ( auto& each : threads )
+            each.join() ;
+
+        assert( consumed_sum == 2 * ( per_producer * ( per_producer + 1 ) / 2 ) ) ;
+        assert( queue.empty() ) ;
+    }
+
+    using task_queue = multi::mpmc_queue< std::function< void() > > ;
+    static_assert( multi::is_bounded_queue< task_queue >::value , "" ) ;
+
+    multi::thread_pool< task_queue > pool{ 4 , multi::RethrowThreadException{} , 8 } ;
+
+    std::atomic< std::size_t > count_times { 0 } ;
+
+    // queue holds only 8 tasks , producers are blocked until workers free the cells
+    std::vector< multi::thread > enqueuers ;
+    for ( std::size_t count = 0 ; count < 3 ; ++ count )
+        enqueuers.emplace_back( [ & ] () {
+            for ( std::size_t count = 0 ; count < 10000 ; ++ count )
+                pool.enqueue( [ & ] () { ++ count_times ; } ) ;
+        } ) ;
+
+    for ( auto& each : enqueuers )
+        each.join() ;
+
+    pool.join() ;
+    std::cerr << "\ncounted : " << count_times ;
+    assert( count_times == 30000 ) ;
+
+    // backpressure : try_enqueue fails once the paused pool has its queue full
+    pool.pause() ;
+
+    std::size_t accepted = 0 ;
+    for ( std::size_t count = 0 ; count < 100 ; ++ count ) {
+        std::function< void() > task = [ & ] () { ++ count_times ; } ;
+        if ( pool.try_enqueue( task ) )
+            ++ accepted ;
+        else
+            assert( task ) ;
+    }
+    assert( accepted == 8 ) ;
+
+    pool.resume() ;
+    pool.join() ;
+    assert( count_times == 30008 ) ;
+
+    // tasks enqueue into the full queue from the workers ; they run the new tasks in place instead of waiting
+    std::function< void( unsigned ) > fan_out = [ & ] ( unsigned depth )
+    {
+        ++ count_times ;
+        if ( depth == 0 )
+            return ;
+
+        for ( unsigned count = 0 ; count < 8 ; ++ count )
+            pool.enqueue( std::bind( fan_out , depth - 1 ) ) ;
+    } ;
+
+    count_times = 0 ;
+    pool.enqueue( std::bind( fan_out , 5 ) ) ;
+    pool.join() ;
+    std::cerr << "\ncounted fan out : " << count_times ;
+    assert( count_times == 1 + 8 + 64 + 512 + 4096 + 32768 ) ;
+
+    { // a chain of successors into a full queue nests in place no deeper than max_inline_depth , then it waits
+        using small_pool = multi::thread_pool< task_queue > ;
+        small_pool pool{ 2 , multi::RethrowThreadException{} , 2 } ;
+
+        std::atomic< bool > is_started { false } , is_chain_started { false } , is_released { false } ;
+        std::atomic< std::size_t > deepest { 0 } , chained { 0 } ;
+        static thread_local std::size_t nesting = 0 ;
+
+        std::function< void( unsigned ) > chain = [ & ] ( unsigned left )
+        {
+            ++ nesting ;
+            std::size_t seen = deepest ;
+            while ( nesting > seen && ! deepest.compare_exchange_weak( seen , nesting ) )
+                ;
+            ++ chained ;
+            if ( left )
+                pool.enqueue( std::bind( chain , left - 1 ) ) ;
+            -- nesting ;
+        } ;
+
+        pool.enqueue( [ & ] () { // holds the other thread , so nobody frees a cell
+            is_started = true ;
+            while ( deepest != small_pool::max_inline_depth + 1 )
+                multi::this_thread::yield() ;
+            multi::this_thread::sleep_for( milliseconds{ 20 } ) ;
+        } ) ;
+        pool.enqueue( [ & ] () {
+            is_chain_started = true ;
+            while ( ! is_released )
+                multi::this_thread::yield() ;
+            chain( 100 ) ;
+        } ) ;
+
+        std::function< void() > filler = [] () { } ;
+        while ( ! is_started || ! is_chain_started ) // both threads are busy , the queue is empty
+            multi::this_thread::yield() ;
+        while ( pool.try_enqueue( filler ) ) 
+            filler = [] () { } ;
+        is_released = true ;
+
+        pool.join() ;
+        assert( chained == 101 ) ;
+        assert( deepest == small_pool::max_inline_depth + 1 ) ;
+    }
+
+    { // a paused pool does not run the task in place ; resume () does
+        using small_pool = multi::thread_pool< task_queue > ;
+        small_pool pool{ 1 , multi::RethrowThreadException{} , 2 } ;
+
+        std::atomic< bool > is_started { false } , is_released { false } , is_run { false } ;
+        pool.enqueue( [ & ] () {
+            is_started = true ;
+            while ( ! is_released )
+                multi::this_thread::yield() ;
+            pool.enqueue( [ & ] () { is_run = true ; } ) ;
+        } ) ;
+
+        std::function< void() > filler = [] () { } ;
+        while ( ! is_started ) 
+            multi::this_thread::yield() ;
+        while ( pool.try_enqueue( filler ) ) 
+            filler = [] () { } ;
+
+        pool.pause() ;
+        is_released = true ;
+        multi::this_thread::sleep_for( milliseconds{ 50 } ) ;
+        assert( ! is_run ) ;
+
+        pool.resume() ;
+        pool.join() ;
+        assert( is_run ) ;
+    }
+
+    std::cerr << "\nbue" ;
+}
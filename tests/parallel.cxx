@@ -0,0 +1,106 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM parallel.cxx -lpthread
+#include <iostream>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <string>
+#include <queue>
+#include <atomic>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../parallel.hxx"
+#include "../work_stealing_queue.hxx"
+#include "../mpmc_queue.hxx"
+#include "../task.hxx"
+
+template < class Pool >
+void test_algorithms ( Pool& pool ) 
+{
+    for ( std::size_t size : { 0 , 1 , 100 , 5000 , 100000 } ) 
+    {
+        std::vector< std::size_t > data ( size ) ;
+        std::iota( data.begin() , data.end() , 1 ) ;
+        
+        multi::parallel_for( pool , data.begin() , data.end() , [] ( std::size_t& value ) { value *= 2 ; } ) ;
+        for ( std::size_t index = 0 ; index < size ; ++ index ) 
+            assert( data[ index ] == 2 * ( index + 1 ) ) ;
+        
+        std::vector< std::size_t > squares ( size ) ;
+        auto end = multi::parallel_transform( pool , data.begin() , data.end() , squares.begin() , 
+                                              [] ( std::size_t value ) { return value * value ; } ) ;
+        assert( end == squares.end() ) ;
+        for ( std::size_t index = 0 ; index < size ; ++ index ) 
+            assert( squares[ index ] == data[ index ] * data[ index ] ) ;
+        
+        std::size_t const sum = multi::parallel_reduce( pool , data.begin() , data.end() , std::size_t{ 7 } , 
+                                                        std::plus< std::size_t >{} ) ;
+        assert( sum == 7 + size * ( size + 1 ) ) ;
+        
+        // small grain : many splits , the order of a non commutative operation is kept
+        std::vector< std::string > letters ( size % 1000 , "a" ) ;
+        for ( std::size_t index = 0 ; index < letters.size() ; ++ index ) 
+            letters[ index ][ 0 ] += index % 26 ;
+        
+        std::string const joined = multi::parallel_reduce( pool , letters.begin() , letters.end() , std::string{ ">" } , 
+                                                           std::plus< std::string >{} , 3 ) ;
+        assert( joined == std::accumulate( letters.begin() , letters.end() , std::string{ ">" } ) ) ;
+    }
+    
+    { // exceptions reach the caller
+        std::vector< int > data ( 10000 , 1 ) ;
+        bool caught = false ;
+        try {
+            multi::parallel_for( pool , data.begin() , data.end() , [] ( int& value ) { 
+                if ( value == 1 ) 
+                    throw std::runtime_error{ "expected" } ; 
+            } , 100 ) ;
+        }
+        catch ( std::runtime_error const& ) { caught = true ; }
+        assert( caught ) ;
+    }
+    
+    { // nested : an algorithm inside of a task of the same pool
+        std::vector< std::vector< int > > rows ( 16 , std::vector< int >( 4096 , 1 ) ) ;
+        std::vector< int > sums ( rows.size() ) ;
+        
+        multi::parallel_transform( pool , rows.begin() , rows.end() , sums.begin() , [ &pool ] ( std::vector< int > const& row ) { 
+            return multi::parallel_reduce( pool , row.begin() , row.end() , 0 , std::plus< int >{} , 256 ) ;
+        } , 1 ) ;
+        
+        for ( int sum : sums ) 
+            assert( sum == 4096 ) ;
+    }
+}
+
+int main ()
+{
+    {
+        multi::thread_pool< std::queue< std::function< void() > > > pool{ 3 } ;
+        test_algorithms( pool ) ;
+    }
+    {
+        multi::thread_pool< multi::work_stealing_queue< multi::task > > pool{ 3 } ;
+        test_algorithms( pool ) ;
+    }
+    { // the queue holds fewer tasks than there are splits ; the rest is run by the splitting threads
+        multi::thread_pool< multi::mpmc_queue< multi::task > > pool{ 2 , {} , 8 } ;
+        test_algorithms( pool ) ;
+        
+        std::vector< std::size_t > data ( 100000 , 1 ) ;
+        multi::parallel_for( pool , data.begin() , data.end() , [] ( std::size_t& value ) { ++ value ; } , 16 ) ;
+        assert( std::count( data.begin() , data.end() , 2 ) == 100000 ) ;
+    }
+    { // no thread takes a task from a paused pool or from one without threads ; the caller does it all
+        multi::thread_pool< multi::work_stealing_queue< multi::task > > paused{ 2 } ;
+        paused.pause() ;
+        test_algorithms( paused ) ;
+        
+        multi::thread_pool< std::queue< std::function< void() > > > empty ;
+        test_algorithms( empty ) ;
+    }
+    
+    std::cerr << "bue" ;
+}
@@ -0,0 +1,149 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM placement.cxx -lpthread
+#include <iostream>
+#include <functional>
+#include <system_error>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../work_stealing_queue.hxx"
+#include "../topology.hxx"
+#include "../thread.hxx"
+#include "../mutex.hxx"
+
+static std::string current_name ()
+{
+    char name [ 16 ] {} ;
+    pthread_getname_np( pthread_self() , name , sizeof( name ) ) ;
+    return name ;
+}
+
+int main ()
+{
+    namespace ns = multi ;
+
+    assert( ( ns::p_::parse_cpu_list_( "0-3,8,10-11" ) == std::vector< unsigned >{ 0 , 1 , 2 , 3 , 8 , 10 , 11 } ) ) ;
+
+    ns::cpu_topology const& topology = ns::cpu_topology::get() ;
+    assert( topology.node_count() >= 1 ) ;
+    for ( std::size_t node = 0 ; node < topology.node_count() ; ++ node )
+        for ( unsigned cpu : topology.node_cpus( node ) )
+            assert( topology.node_of_cpu( cpu ) == node ) ;
+
+    unsigned const first_cpu = topology.node_cpus( 0 ).front() ;
+
+    { // attributes reach the thread
+        ns::thread::attributes attrs ;
+        attrs.stack_size = 1 << 20 ;
+        attrs.name = "multi-attributes-test" ;
+        attrs.cpus = { first_cpu } ;
+
+        std::string name ;
+        int cpu = -1 ;
+        std::size_t stack_size = 0 ;
+
+        ns::thread worker { attrs , [ & ] () {
+            name = current_name() ;
+            cpu = sched_getcpu() ;
+
+            pthread_attr_t attr ;
+            pthread_getattr_np( pthread_self() , &attr ) ;
+            pthread_attr_getstacksize( &attr , &stack_size ) ;
+            pthread_attr_destroy( &attr ) ;
+        } } ;
+        worker.join() ;
+
+        assert( name == "multi-attribute" ) ; // 15 characters
+        assert( cpu == static_cast< int >( first_cpu ) ) ;
+        assert( stack_size >= attrs.stack_size ) ;
+
+        attrs = ns::thread::attributes{} ;
+        attrs.policy = SCHED_FIFO ;
+        attrs.priority = 100000 ;
+
+        bool thrown = false ;
+        try { ns::thread bad { attrs , [] () { } } ; bad.join() ; }
+        catch ( std::system_error const& ) { thrown = true ; }
+        assert( thrown ) ;
+    }
+
+    { // placements
+        ns::thread_placement cores { ns::thread_placement::mode::core } ;
+        ns::thread_placement nodes { ns::thread_placement::mode::node } ;
+
+        assert( ns::thread_placement{}( 3 ).cpus.empty() ) ;
+        assert( ( cores( 0 ).cpus == std::vector< unsigned >{ first_cpu } ) ) ;
+        assert( nodes( topology.node_count() ).cpus == topology.node_cpus( 0 ) ) ;
+    }
+
+    { // a pinned , named pool
+        ns::thread::attributes base ;
+        base.name = "pool-" ;
+
+        ns::thread_pool< ns::work_stealing_queue< std::function< void() > > > pool ;
+        pool.set_thread_placement( ns::thread_placement{ ns::thread_placement::mode::core , base } ) ;
+        pool.add_thread( 4 ) ;
+        pool.resume() ; // a pool without threads is created paused
+
+        ns::mutex mtx ;
+        std::vector< std::string > names ;
+        std::atomic< std::size_t > unpinned { 0 } ;
+
+        for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+            pool.enqueue( [ & ] () {
+                cpu_set_t cpu_set ;
+                pthread_getaffinity_np( pthread_self() , sizeof( cpu_set ) , &cpu_set ) ;
+                if ( CPU_COUNT( &cpu_set ) != 1 )
+                    ++ unpinned ;
+
+                ns::lock_guard< ns::mutex > lock { mtx } ;
+                names.push_back( current_name() ) ;
+            } ) ;
+        pool.join() ;
+
+        assert( unpinned == 0 ) ;
+        for ( auto const& name : names )
+            assert( name.compare( 0 , 5 , "pool-" ) == 0 ) ;
+    }
+
+    { // a thread added after remove_thread () takes the index of the removed one
+        ns::thread::attributes base ;
+        base.name = "slot-" ;
+
+        ns::thread_pool< ns::work_stealing_queue< std::function< void() > > > pool ;
+        pool.set_thread_placement( ns::thread_placement{ ns::thread_placement::mode::any , base } ) ;
+        pool.add_thread( 3 ) ;
+        pool.resume() ;
+
+        pool.remove_thread() ;
+        pool.add_thread() ;
+
+        ns::mutex mtx ;
+        std::vector< std::string > names ;
+        std::atomic< std::size_t > arrived { 0 } ;
+
+        for ( std::size_t count = 0 ; count < 3 ; ++ count ) // every thread holds one till all of them are there
+            pool.enqueue( [ & ] () {
+                {
+                    ns::lock_guard< ns::mutex > lock { mtx } ;
+                    names.push_back( current_name() ) ;
+                }
+                ++ arrived ;
+                while ( arrived != 3 )
+                    ns::this_thread::yield() ;
+            } ) ;
+
+        while ( arrived != 3 )
+            ns::this_thread::yield() ;
+        pool.join() ;
+
+        std::sort( names.begin() , names.end() ) ;
+        assert( ( names == std::vector< std::string >{ "slot-0" , "slot-1" , "slot-2" } ) ) ;
+    }
+
+    std::cerr << "bue" ;
+}
@@ -0,0 +1,143 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM pool_stats.cxx -lpthread
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <atomic>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../mpmc_queue.hxx"
+#include "../work_stealing_queue.hxx"
+#include "../task_group.hxx"
+#include "../task.hxx"
+
+template < class Queue >
+using stats_pool = multi::thread_pool< Queue , multi::RethrowThreadException , multi::CollectPoolStats > ;
+
+// every way to put a task in is counted once for the run time and once for the queue wait
+template < class Pool >
+void check_counts ( Pool& pool , std::size_t const threads )
+{
+    std::atomic< std::size_t > count_times { 0 } ;
+    auto increment = [ &count_times ] () { ++ count_times ; } ;
+
+    for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+        pool.enqueue( increment ) ;
+
+    for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+        pool.emplace( increment ) ;
+
+    std::vector< typename Pool::task_type > tasks ;
+    for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+        tasks.emplace_back( increment ) ;
+    auto it = tasks.begin() ;
+    pool.enqueue( it , tasks.end() ) ;
+
+    auto result = pool.submit( [] ( int value ) { return value * 2 ; } , 21 ) ;
+    {
+        multi::task_group< Pool > group { pool } ;
+        for ( std::size_t count = 0 ; count < 100 ; ++ count )
+            group.run( increment ) ;
+        group.wait() ;
+    }
+
+    assert( result.get() == 42 ) ;
+    pool.join() ;
+    assert( count_times == 3100 ) ;
+
+    multi::pool_stats_snapshot const stats = pool.stats_policy().snapshot() ;
+
+    assert( stats.workers.size() == threads + 1 ) ;
+    assert( stats.tasks() == 3101 ) ;
+    assert( stats.run_time.count() == 3101 ) ;
+    assert( stats.queue_wait.count() == 3101 ) ;
+    assert( stats.futile_wakeups <= stats.wakeups ) ;
+    assert( stats.run_time.percentile( 0.5 ) <= stats.run_time.percentile( 0.99 ) ) ;
+
+    std::ostringstream out ;
+    out << stats ;
+    assert( out.str().find( "tasks : 3101" ) == 0 ) ;
+
+    pool.stats_policy().reset() ;
+    assert( pool.stats_policy().snapshot().tasks() == 0 ) ;
+    assert( pool.stats_policy().snapshot().queue_wait.count() == 0 ) ;
+}
+
+int main ()
+{
+    using namespace std::chrono ;
+    using function_queue = std::queue< std::function< void() > > ;
+
+    { // off by default , nothing is recorded
+        using pool_type = multi::thread_pool< function_queue > ;
+        static_assert( ! pool_type::is_stats_enabled::value , "stats are off by default" ) ;
+    }
+
+    { // histogram buckets are powers of two
+        using multi::duration_histogram ;
+        assert( duration_histogram::bucket_of( nanoseconds{ 0 } ) == 0 ) ;
+        assert( duration_histogram::bucket_of( nanoseconds{ 1 } ) == 0 ) ;
+        assert( duration_histogram::bucket_of( nanoseconds{ 2 } ) == 1 ) ;
+        assert( duration_histogram::bucket_of( nanoseconds{ 1000 } ) == 9 ) ;
+
+        duration_histogram histogram ;
+        histogram.buckets[ 3 ] = 99 ;
+        histogram.buckets[ 10 ] = 1 ;
+        assert( histogram.count() == 100 ) ;
+        assert( histogram.percentile( 0.5 ) == nanoseconds{ 16 } ) ;
+        assert( histogram.percentile( 1.0 ) == nanoseconds{ 2048 } ) ;
+    }
+
+    {
+        stats_pool< function_queue > pool { 3 } ;
+        check_counts( pool , 3 ) ;
+    }
+
+    {
+        stats_pool< function_queue > pool { 2 } ;
+        pool.set_dequeue_batch( 8 ) ;
+        check_counts( pool , 2 ) ;
+    }
+
+    {
+        stats_pool< multi::mpmc_queue< std::function< void() > > > pool { 2 , {} , 64 } ;
+        check_counts( pool , 2 ) ;
+    }
+
+    {
+        stats_pool< multi::work_stealing_queue< multi::task > > pool { 4 } ;
+        check_counts( pool , 4 ) ;
+    }
+
+    { // try_enqueue into a bounded queue leaves the task as it is , so it is not stamped
+        stats_pool< multi::mpmc_queue< multi::task > > pool { 1 , {} , 4 } ;
+
+        multi::task the_task { [] () { } } ;
+        assert( pool.try_enqueue( the_task ) ) ;
+        pool.join() ;
+
+        multi::pool_stats_snapshot const stats = pool.stats_policy().snapshot() ;
+        assert( stats.tasks() == 1 ) ;
+        assert( stats.queue_wait.count() == 0 ) ;
+    }
+
+    { // a task queued behind a slow one waits at least as long as the slow one runs
+        stats_pool< function_queue > pool { 1 } ;
+
+        pool.enqueue( [] () { multi::this_thread::sleep_for( milliseconds{ 20 } ) ; } ) ;
+        pool.enqueue( [] () { } ) ;
+        pool.join() ;
+
+        multi::pool_stats_snapshot const stats = pool.stats_policy().snapshot() ;
+        assert( stats.workers[ 0 ].tasks == 2 ) ;
+        assert( stats.workers[ 0 ].busy >= milliseconds{ 20 } ) ;
+        assert( stats.queue_wait.percentile( 1.0 ) > milliseconds{ 16 } ) ;
+        assert( stats.notifications >= 1 ) ;
+
+        std::cerr << stats ;
+    }
+
+    std::cerr << "\nbue" ;
+}
@@ -0,0 +1,117 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM task.cxx -lpthread
+#include <iostream>
+#include <queue>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../mpmc_queue.hxx"
+#include "../task.hxx"
+
+static std::atomic< std::size_t > allocations { 0 } ;
+
+void * operator new ( std::size_t size )
+{
+    ++ allocations ;
+    if ( void * ptr = std::malloc( size ? size : 1 ) )
+        return ptr ;
+    throw std::bad_alloc{} ;
+}
+
+// gcc inlines the free () below into the callers of new and takes it for a mismatch
+#if defined( __GNUC__ ) && ! defined( __clang__ ) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete ( void * ptr ) noexcept { std::free( ptr ) ; }
+
+void operator delete ( void * ptr , std::size_t ) noexcept { operator delete( ptr ) ; }
+
+int main ()
+{
+    static_assert( sizeof( multi::task ) <= 64 , "" ) ;
+
+    { // small captures stay inline
+        int value = 0 ;
+        std::size_t const before = allocations ;
+
+        multi::task task { [ &value ] () { ++ value ; } } ;
+        multi::task moved { std::move( task ) } ;
+        assert( ! task && moved ) ;
+        moved() ;
+
+        multi::task bound { [] ( int& ref , int add ) { ref += add ; } , std::ref( value ) , 2 } ;
+        bound() ;
+
+        assert( allocations == before ) ;
+        assert( value == 3 ) ;
+    }
+
+    { // big ones go to the heap , move-only captures are fine
+        struct big { char data[ 128 ] ; } payload {} ;
+        std::unique_ptr< int > owned { new int{ 7 } } ;
+        int result = 0 ;
+
+        std::size_t const before = allocations ;
+        multi::task task { [ payload , &result ] () { result = payload.data[ 0 ] + 1 ; } } ;
+        assert( allocations == before + 1 ) ;
+        task() ;
+        assert( result == 1 ) ;
+
+        multi::basic_task< 64 > with_owned { std::bind( [ &result ] ( std::unique_ptr< int >& ptr ) { result = * ptr ; } ,
+                                                        std::move( owned ) ) } ;
+        with_owned() ;
+        assert( result == 7 ) ;
+    }
+
+    { // only what can be called with no arguments converts to a task ; null callables make an empty one
+        static_assert( std::is_convertible< void (*) () , multi::task >::value , "" ) ;
+        static_assert( ! std::is_convertible< int , multi::task >::value , "" ) ;
+        static_assert( ! std::is_convertible< void (*) ( int ) , multi::task >::value , "" ) ;
+        static_assert( ! std::is_constructible< multi::task , std::function< void( int ) > >::value , "" ) ;
+
+        void ( * null_func ) () = nullptr ;
+        multi::task from_pointer { null_func } ;
+        assert( ! from_pointer ) ;
+
+        multi::task from_function { std::function< void() >{} } ;
+        assert( ! from_function ) ;
+
+        multi::task from_lambda { [] () { } } ;
+        assert( from_lambda ) ;
+    }
+
+    std::atomic< std::size_t > count_times { 0 } ;
+
+    {
+        multi::thread_pool< std::queue< multi::task > > pool{ 2 } ;
+
+        for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+            pool.emplace( [ &count_times ] ( std::size_t add ) { count_times += add ; } , 1 ) ;
+        pool.join() ;
+        assert( count_times == 1000 ) ;
+    }
+
+    {
+        multi::thread_pool< multi::mpmc_queue< multi::task > > pool{ 2 } ;
+
+        // the queue cells are preallocated ; in-place construction and a submit with one allocation
+        std::size_t const before = allocations ;
+        for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+            pool.emplace( [ &count_times ] () { ++ count_times ; } ) ;
+        pool.join() ;
+        assert( allocations == before ) ;
+        assert( count_times == 2000 ) ;
+
+        std::size_t const before_submit = allocations ;
+        multi::future< int > answer = pool.submit( [] () { return 42 ; } ) ;
+        assert( allocations == before_submit + 1 ) ;
+        assert( answer.get() == 42 ) ;
+    }
+
+    std::cerr << "bue" ;
+}
@@ -0,0 +1,141 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM task_group.cxx -lpthread
+#include <iostream>
+#include <functional>
+#include <stdexcept>
+#include <queue>
+#include <atomic>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../task_group.hxx"
+#include "../mpmc_queue.hxx"
+#include "../work_stealing_queue.hxx"
+#include "../task.hxx"
+
+// every level waits for its children inside of a pool task ; 
+// without helping , two threads would be blocked after the second level
+template < class Pool >
+std::size_t fork_join ( Pool& pool , unsigned const depth )
+{
+    if ( depth == 0 ) 
+        return 1 ;
+    
+    std::size_t left = 0 , right = 0 ;
+    
+    multi::task_group< Pool > group { pool } ;
+    group.run( [ & ] () { left  = fork_join( pool , depth - 1 ) ; } ) ;
+    group.run( [ & ] () { right = fork_join( pool , depth - 1 ) ; } ) ;
+    group.wait() ;
+    
+    return left + right ;
+}
+
+template < class Pool >
+void test_fork_join ( Pool& pool ) 
+{
+    std::size_t leaves = 0 ;
+    
+    multi::task_group< Pool > group { pool } ;
+    group.run( [ & ] () { leaves = fork_join( pool , 10 ) ; } ) ;
+    group.wait() ;
+    
+    assert( leaves == 1024 ) ;
+}
+
+int main ()
+{
+    using namespace std::chrono ;
+    using function_queue = std::queue< std::function< void() > > ;
+    using function_pool = multi::thread_pool< function_queue > ;
+    
+    { // a group does not wait for the tasks of another one
+        function_pool pool{ 2 } ;
+        
+        std::atomic< bool > slow_started { false } , slow_done { false } ;
+        std::atomic< std::size_t > count_times { 0 } ;
+        
+        multi::task_group< function_pool > slow { pool } , fast { pool } ;
+        slow.run( [ & ] () { 
+            slow_started = true ;
+            multi::this_thread::sleep_for( milliseconds{ 300 } ) ; 
+            slow_done = true ;
+        } ) ;
+        
+        while ( ! slow_started ) // otherwise fast.wait () could help with it 
+            multi::this_thread::yield() ;
+        
+        for ( std::size_t count = 0 ; count < 100 ; ++ count ) 
+            fast.run( [ & ] () { ++ count_times ; } ) ;
+        fast.wait() ;
+        
+        assert( count_times == 100 ) ;
+        assert( ! slow_done && ! slow.is_done() ) ;
+        
+        slow.wait() ;
+        assert( slow_done ) ;
+    }
+    
+    { // recursive fork / join with fewer threads than levels
+        function_pool locked_pool{ 2 } ;
+        test_fork_join( locked_pool ) ;
+        
+        multi::thread_pool< multi::work_stealing_queue< multi::task > > stealing_pool{ 2 } ;
+        test_fork_join( stealing_pool ) ;
+        
+        multi::thread_pool< multi::mpmc_queue< multi::task > > mpmc_pool{ 2 } ;
+        test_fork_join( mpmc_pool ) ;
+    }
+    
+    { // the queue is smaller than the number of pending tasks ; those that do not fit are run by the caller
+        using small_pool = multi::thread_pool< multi::mpmc_queue< multi::task > > ;
+        small_pool pool{ 2 , {} , 4 } ;
+        test_fork_join( pool ) ;
+        
+        pool.pause() ;
+        std::atomic< std::size_t > count_times { 0 } ;
+        
+        multi::task_group< small_pool > group { pool } ;
+        for ( std::size_t count = 0 ; count < 100 ; ++ count ) 
+            group.run( [ & ] () { ++ count_times ; } ) ;
+        assert( count_times == 100 - 4 ) ;
+        
+        pool.resume() ;
+        group.wait() ;
+        assert( count_times == 100 ) ;
+    }
+    
+    { // the first exception is rethrown by wait ()
+        function_pool pool{ 2 } ;
+        multi::task_group< function_pool > group { pool } ;
+        
+        for ( std::size_t count = 0 ; count < 10 ; ++ count ) 
+            group.run( [] ( std::size_t no ) { if ( no == 5 ) throw std::runtime_error{ "expected" } ; } , count ) ;
+        
+        bool caught = false ;
+        try { group.wait() ; } 
+        catch ( std::runtime_error const& ) { caught = true ; }
+        assert( caught ) ;
+        
+        group.wait() ; // reported once
+    }
+    
+    { // discarded tasks are done with broken_promise
+        using stealing_pool = multi::thread_pool< multi::work_stealing_queue< multi::task > > ;
+        stealing_pool pool{ 1 } ;
+        pool.pause() ;
+        
+        multi::task_group< stealing_pool > group { pool } ;
+        for ( std::size_t count = 0 ; count < 10 ; ++ count ) 
+            group.run( [] () { } ) ;
+        
+        pool.discard_queue() ;
+        assert( group.is_done() ) ;
+        
+        bool caught = false ;
+        try { group.wait() ; } 
+        catch ( multi::future_error const& ) { caught = true ; }
+        assert( caught ) ;
+    }
+    
+    std::cerr << "bue" ;
+}
@@ -1,4 +1,5 @@
 // g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM test0.cxx -lpthread
+// g++ -Wall -pedantic -std=c++11 -D MULTI_LINUX_FUTEX_PLATFORM test0.cxx -lpthread
 // i686-w64-mingw32-g++ -Wall -pedantic -static -std=c++11 -D MULTI_WINAPI_PLATFORM test0.cxx
 // i686-w64-mingw32-g++ -Wall -pedantic -static -std=c++11 -D MULTI_POSIX_PLATFORM test0.cxx -lpthread
 #include "../thread.hxx"
@@ -0,0 +1,171 @@
+// g++ -Wall -pedantic -std=c++11 -D MULTI_POSIX_PLATFORM work_stealing_pool.cxx -lpthread
+#include <iostream>
+#include <functional>
+#include <queue>
+#include <atomic>
+#include <cassert>
+
+#include "../thread_pool.hxx"
+#include "../work_stealing_queue.hxx"
+
+// try_pop stalls once after it is armed
+struct stalling_queue
+{
+    using value_type = std::function< void() > ;
+    using queue_category = multi::concurrent_queue_tag ;
+
+    void push ( value_type value ) { queue.push( std::move( value ) ) ; }
+
+    template < class... Args >
+    void emplace ( Args&&... args ) { queue.emplace( std::forward< Args >( args )... ) ; }
+
+    bool try_pop ( value_type& value )
+    {
+        if ( is_armed.exchange( false ) ) {
+            is_stalling = true ;
+            multi::this_thread::sleep_for( std::chrono::milliseconds{ 50 } ) ;
+        }
+        return queue.try_pop( value ) ;
+    }
+
+    std::size_t clear () { return queue.clear() ; }
+    void attach_worker () { queue.attach_worker() ; }
+    void detach_worker () noexcept { queue.detach_worker() ; }
+
+    static std::atomic< bool > is_armed , is_stalling ;
+
+    multi::work_stealing_queue< value_type > queue ;
+} ;
+
+std::atomic< bool > stalling_queue::is_armed { false } ;
+std::atomic< bool > stalling_queue::is_stalling { false } ;
+
+int main ()
+{
+    using namespace std::chrono ;
+    using stealing_queue = multi::work_stealing_queue< std::function< void() > > ;
+
+    static_assert( multi::is_concurrent_queue< stealing_queue >::value , "" ) ;
+    static_assert( ! multi::is_concurrent_queue< std::queue< std::function< void() > > >::value , "" ) ;
+
+    multi::thread_pool< stealing_queue > pool{ 4 } ;
+
+    std::atomic< std::size_t > count_times { 0 } ;
+
+    // every task spawns more tasks from inside of the pool ; they go to local deques and are stolen
+    std::function< void( unsigned ) > fan_out = [ & ] ( unsigned depth )
+    {
+        ++ count_times ;
+        if ( depth == 0 )
+            return ;
+
+        for ( unsigned count = 0 ; count < 4 ; ++ count )
+            pool.enqueue( std::bind( fan_out , depth - 1 ) ) ;
+    } ;
+
+    std::size_t const expected = 1 + 4 + 16 + 64 + 256 + 1024 + 4096 ;
+
+    pool.enqueue( std::bind( fan_out , 6 ) ) ;
+    pool.join() ;
+
+    std::cerr << "\ncounted : " << count_times ;
+    assert( count_times == expected ) ;
+
+    pool.pause() ;
+
+    count_times = 0 ;
+    for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+        pool.enqueue( [ & ] () { ++ count_times ; } ) ;
+
+    multi::this_thread::sleep_for( milliseconds{ 100 } ) ;
+    assert( count_times == 0 ) ;
+
+    pool.remove_thread() ;
+    pool.remove_thread() ;
+
+    pool.resume() ;
+    pool.join() ;
+
+    std::cerr << "\ncounted after resume : " << count_times ;
+    assert( count_times == 1000 ) ;
+
+    pool.add_thread( 2 ) ;
+
+    count_times = 0 ;
+    pool.enqueue( std::bind( fan_out , 6 ) ) ;
+    pool.join() ;
+    assert( count_times == expected ) ;
+
+    pool.pause() ;
+    for ( std::size_t count = 0 ; count < 1000 ; ++ count )
+        pool.enqueue( [ & ] () { ++ count_times ; } ) ;
+
+    pool.discard_queue() ;
+    pool.resume() ;
+    pool.join() ;
+
+    assert( count_times == expected ) ;
+
+    { // pause () lands between the state check of a worker and its pop ; the task it holds till resume () is discarded too
+        multi::thread_pool< stalling_queue > stalling_pool{ 1 } ;
+
+        std::atomic< bool > is_released { false } ;
+        std::atomic< bool > is_pushed { false } ;
+        stalling_pool.enqueue( [ & ] () { // the next task goes to the deque of the worker
+            stalling_pool.enqueue( [ & ] () { ++ count_times ; } ) ;
+            is_pushed = true ;
+            while ( ! is_released ) 
+                multi::this_thread::yield() ;
+        } ) ;
+        while ( ! is_pushed ) 
+            multi::this_thread::yield() ;
+
+        stalling_queue::is_armed = true ;
+        is_released = true ;
+        while ( ! stalling_queue::is_stalling ) 
+            multi::this_thread::yield() ;
+
+        stalling_pool.pause() ;
+        multi::this_thread::sleep_for( milliseconds{ 100 } ) ; // the worker pops and holds the task
+
+        std::size_t const settled = count_times ;
+        stalling_pool.discard_queue() ;
+        stalling_pool.resume() ;
+        stalling_pool.join() ;
+
+        assert( count_times == settled ) ;
+    }
+
+    { // a task enqueued after discard_queue () returned is kept , though a stalled pop holds it till resume ()
+        multi::thread_pool< stalling_queue > stalling_pool{ 1 } ;
+
+        std::atomic< bool > is_released { false } ;
+        std::atomic< bool > is_started { false } ;
+        stalling_pool.enqueue( [ & ] () {
+            is_started = true ;
+            while ( ! is_released ) 
+                multi::this_thread::yield() ;
+        } ) ;
+        while ( ! is_started ) 
+            multi::this_thread::yield() ;
+
+        stalling_queue::is_stalling = false ;
+        stalling_queue::is_armed = true ;
+        is_released = true ;
+        while ( ! stalling_queue::is_stalling ) 
+            multi::this_thread::yield() ;
+
+        stalling_pool.pause() ;
+        stalling_pool.discard_queue() ;
+
+        std::atomic< std::size_t > ran { 0 } ;
+        stalling_pool.enqueue( [ & ] () { ++ ran ; } ) ;
+        multi::this_thread::sleep_for( milliseconds{ 100 } ) ; // the worker pops and holds the task
+
+        stalling_pool.resume() ;
+        stalling_pool.join() ;
+        assert( ran == 1 ) ;
+    }
+
+    std::cerr << "\nbue" ;
+}
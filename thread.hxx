@@ -1,7 +1,7 @@
 #ifndef MULTI_THREAD_HXX
 #define MULTI_THREAD_HXX
 
-#ifdef MULTI_POSIX_PLATFORM
+#if defined MULTI_POSIX_PLATFORM || defined MULTI_LINUX_FUTEX_PLATFORM // futex backend has only own synchronization primitives
     #include "sources/POSIX/thread.hxx"
 #elif defined MULTI_WINAPI_PLATFORM
     #include "sources/WinAPI/thread.hxx"
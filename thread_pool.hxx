@@ -14,7 +14,13 @@
 // http://www.domaigne.com/blog/computing/condvars-signal-with-mutex-locked-or-not/
 
 #include <utility>
+#include <functional>
+#include <type_traits>
+#include <tuple>
+#include <atomic>
 #include <bitset>
+#include <vector>
+#include <chrono>
 #include <iostream>
 #include <ostream>
 #include <cstddef>
@@ -23,6 +29,10 @@
 #include "mutex.hxx"
 #include "condition_variable.hxx"
 #include "thread.hxx"
+#include "topology.hxx"
+#include "queue_traits.hxx"
+#include "future.hxx"
+#include "pool_stats.hxx"
 
 
 //using namespace std ;
@@ -59,6 +69,64 @@ namespace p_
     inline scope_guard< F > make_guard ( F&& func ) {
         return scope_guard< F >{ std::forward< F >( func ) } ;
     }
+    
+    template < std::size_t... Indices >
+    struct index_sequence { } ;
+    
+    template < std::size_t Size , std::size_t... Indices >
+    struct make_index_sequence : make_index_sequence< Size - 1 , Size - 1 , Indices... > { } ;
+    
+    template < std::size_t... Indices >
+    struct make_index_sequence< 0 , Indices... > { using type = index_sequence< Indices... > ; } ;
+    
+    // a pointer to member is called through std::mem_fn , as INVOKE does
+    template < class F >
+    typename std::enable_if< ! std::is_member_pointer< F >::value , F&& >::type invocable ( F& func ) noexcept 
+    {
+        return std::move( func ) ;
+    }
+    
+    template < class F >
+    auto invocable ( F& func ) noexcept 
+        -> typename std::enable_if< std::is_member_pointer< F >::value , decltype( std::mem_fn( func ) ) >::type 
+    {
+        return std::mem_fn( func ) ;
+    }
+    
+    // decayed copies of the callable and of the arguments , called once with all of them as rvalues , 
+    // as std::async and std::packaged_task do ; so move-only arguments are fine , and placeholders or 
+    // bind expressions among the arguments are passed as they are , unlike std::bind.
+    template < class F , class... Args >
+    struct deferred_call final
+    {
+        using result_type = decltype( invocable( std::declval< F& >() )( std::declval< Args >()... ) ) ;
+        
+        explicit deferred_call ( F func , Args... args ) 
+            : func_( std::move( func ) ) , args_( std::move( args )... ) 
+        {
+        }
+        
+        result_type operator () () 
+        {
+            return call_( typename make_index_sequence< sizeof...( Args ) >::type{} ) ;
+        }
+        
+        private :
+            template < std::size_t... Indices >
+            result_type call_ ( index_sequence< Indices... > ) 
+            {
+                return invocable( func_ )( std::move( std::get< Indices >( args_ ) )... ) ;
+            }
+            
+            F func_ ;
+            std::tuple< Args... > args_ ;
+    } ;
+    
+    template < class F , class... Args >
+    using bound_t = deferred_call< typename std::decay< F >::type , typename std::decay< Args >::type... > ;
+    
+    template < class F , class... Args >
+    using bound_result_t = typename bound_t< F , Args... >::result_type ;
 }
 
 struct RethrowThreadException // terminate
@@ -122,7 +190,8 @@ struct TryLogThreadException
 template 
 <
     class Queue ,
-    class ThreadExceptionPolicy = RethrowThreadException 
+    class ThreadExceptionPolicy = RethrowThreadException ,
+    class StatsPolicy = NoPoolStats // see pool_stats.hxx
 >
 struct thread_pool final 
     : private ThreadExceptionPolicy
@@ -130,17 +199,39 @@ struct thread_pool final
     using task_type = typename Queue::value_type ;
     using task_queue_type = Queue ;
     using exception_policy_type = ThreadExceptionPolicy ;
+    using stats_policy_type = StatsPolicy ;
+    using is_concurrent = is_concurrent_queue< Queue > ; // queue_mtx_ is not taken to push / pop tasks
+    using is_bounded = is_bounded_queue< Queue > ;       // enqueue () blocks while the queue is full
+    using is_stats_enabled = std::integral_constant< bool , StatsPolicy::enabled > ;
+    
+    // enqueue () called from a task of the pool runs the new task in place when a bounded queue is full ; 
+    // tasks run so may enqueue in place again , up to this depth
+    static constexpr std::size_t max_inline_depth = 16 ;
     
     explicit thread_pool( std::size_t const thread_num = 0 , 
                           ThreadExceptionPolicy policy = ThreadExceptionPolicy() ) 
         : ThreadExceptionPolicy( std::move( policy ) ) ,
-          thread_count_{} , active_count_{} ,
+          thread_count_{} , active_count_{} , helping_count_{} , client_waiters_{} , dequeue_batch_{ 1 } ,
+          sleeping_count_{ 0 } , unfinished_count_{ 0 } , blocked_count_{ 0 } , discard_count_{ 0 } ,
           state_{ thread_num ? EXECUTING : PAUSED } 
     {
       // if ( auto  = add_thread( thread_num ) ;
          add_thread( thread_num ) ;
     }
     
+    template < class... QueueArgs >
+    thread_pool( std::size_t const thread_num , 
+                 ThreadExceptionPolicy policy , 
+                 QueueArgs&&... queue_args ) // e.g. capacity of mpmc_queue
+        : ThreadExceptionPolicy( std::move( policy ) ) ,
+          queue_( std::forward< QueueArgs >( queue_args )... ) ,
+          thread_count_{} , active_count_{} , helping_count_{} , client_waiters_{} , dequeue_batch_{ 1 } ,
+          sleeping_count_{ 0 } , unfinished_count_{ 0 } , blocked_count_{ 0 } , discard_count_{ 0 } ,
+          state_{ thread_num ? EXECUTING : PAUSED } 
+    {
+         add_thread( thread_num ) ;
+    }
+    
     ~ thread_pool ()
     {
         try { clear() ; } // it has not to be concurrent call
@@ -160,9 +251,11 @@ struct thread_pool final
         
         for ( std::size_t count = 0 ; count < thread_num ; ++ count ) 
         {
-            try { thread( &thread_pool::routine , this ).detach() ; }
+            std::size_t const index = take_placement_index_() ;
+            try { thread( placement_( index ) , &thread_pool::routine , this , index ).detach() ; }
             catch ( ... )
             {
+                placement_used_[ index ] = false ;
                 //action_ = FINISH ;
                 //queue_cv_.notify_all() ;        
                 throw ;
@@ -170,7 +263,18 @@ struct thread_pool final
         }
         //if (  )
         
-        client_cv_.wait( lock , [ this , new_count ] { return thread_count_ == new_count ; } ) ;
+        wait_client_( lock , [ this , new_count ] { return thread_count_ == new_count ; } ) ;
+    }
+    
+    // applies to the threads added after it ; e.g. to pin workers to cores :
+    //     multi::thread_pool< ... > pool ;
+    //     pool.set_thread_placement( multi::thread_placement{ multi::thread_placement::mode::core } ) ;
+    //     pool.add_thread( 8 ) ;
+    // work_stealing_queue lets a worker steal from workers of its own numa node first.
+    void set_thread_placement ( thread_placement placement ) 
+    {
+        lock_guard< mutex > op_lock { op_mtx_ } ;
+        placement_ = std::move( placement ) ;
     }
     
     void remove_thread ()                                                               // TODO
@@ -183,7 +287,7 @@ struct thread_pool final
         
         std::size_t const new_count = thread_count_ - 1 ;
         
-        auto const prev_state = state_ ;
+        auto const prev_state = state_.load() ;
         state_ = PAUSED ;
         
         auto set_state_back 
@@ -194,7 +298,7 @@ struct thread_pool final
                 }
             } ) ;
         
-        client_cv_.wait ( lock , [ this ] ( ) { // note : may throw
+        wait_client_( lock , [ this ] ( ) { // note : may throw
             return active_count_ != thread_count_ ; 
         } ) ;
         
@@ -202,7 +306,7 @@ struct thread_pool final
         
         queue_cv_.notify_one() ;
         
-        client_cv_.wait( lock , [ this , new_count ] ( ) { // note : may throw
+        wait_client_( lock , [ this , new_count ] ( ) { // note : may throw
             return thread_count_ == new_count ; 
         } ) ;
     }
@@ -217,7 +321,7 @@ struct thread_pool final
         
         state_ = PAUSED ;
         
-        client_cv_.wait ( lock , [ this ] ( ) { 
+        wait_client_( lock , [ this ] ( ) { 
             return active_count_ == 0 ; 
         } ) ;
         
@@ -226,7 +330,7 @@ struct thread_pool final
 
         queue_cv_.notify_all() ;
         
-        client_cv_.wait ( lock , [ this ] ( ) { // note : may throw
+        wait_client_( lock , [ this ] ( ) { // note : may throw
             return thread_count_ == 0 ; 
         } ) ;
     }
@@ -235,47 +339,112 @@ struct thread_pool final
                 // it's a general, obviously not excelent solution. to avoid this join, 
                 // task type with future support can be used ( or just with some discarding mechanism )
     {
-        unique_lock< mutex > lock { queue_mtx_ } ;
-        client_cv_.wait( lock , 
-                   [ this ] ( ) { return queue_.empty() && active_count_ == 0 ; } ) ; // active_count_ == 0 ;
-        
+        join_( is_concurrent{} ) ;
     }
         
     void discard_queue () 
     { 
-        lock_guard< mutex > lock { queue_mtx_ } ;
-        queue_.clear() ; 
+        discard_queue_( is_concurrent{} ) ;
     }
     
+    // waits while a bounded queue is full. called from a task of this pool it may run the_task 
+    // synchronously on the calling thread instead , before enqueue () returns ( not while the pool is paused , 
+    // and for up to max_inline_depth nested calls ) ; so the caller must not hold a lock the_task takes.
     void enqueue ( task_type the_task ) 
     {
-        unique_lock< mutex > lock { queue_mtx_ } ;
-        queue_.emplace( std::move( the_task ) ) ;
-        queue_cv_.notify_one() ; // vs chained notify_one whith mutex unlocked (prof).?
+        enqueue_( stamp_( std::move( the_task ) , is_stats_enabled{} ) , is_concurrent{} ) ;
     }
     
-    template < class InputIt >
-    void enqueue ( InputIt& it , InputIt to ) // move iterator
+    // the task is constructed from args... right in the queue , without a temporary 
+    // ( e.g. from a callable and its arguments for multi::task ). 
+    // bounded queues construct in place only if that can not throw .
+    // with the stats enabled the task is constructed and then stamped , as by enqueue () .
+    template < class... Args >
+    void emplace ( Args&&... args ) 
     {
-        lock_guard< mutex > lock { queue_mtx_ } ;
+        emplace_stamped_( is_stats_enabled{} , std::forward< Args >( args )... ) ;
+    }
+    
+    // the result ( or the exception ) of func( args... ) is delivered through the future ; 
+    // the callable , the arguments and the result share one allocation. 
+    // args are decay-copied and handed to func as rvalues , as by std::async ( move-only ones are fine ). 
+    // if the task is discarded , the future gets future_errc::broken_promise.
+    template < class F , class... Args >
+    future< p_::bound_result_t< F , Args... > > submit ( F&& func , Args&&... args )
+    {
+        using bound_type  = p_::bound_t< F , Args... > ;
+        using result_type = p_::bound_result_t< F , Args... > ;
+        using state_type  = p_::task_state< result_type , bound_type > ;
         
-        if ( it == to ) 
-            return ;
+        state_type * state = new state_type( bound_type( std::forward< F >( func ) , 
+                                                         std::forward< Args >( args )... ) ) ;
         
-        for ( std::size_t count = 0 ; it != to ; ++ it ) try 
-        {
-            queue_.emplace( * it ) ;
-            ++ count ;
-        } 
-        catch ( ... ) {
-            if ( count ) {
-                queue_cv_.notify_all() ;
-            }
-            throw ; 
-        }
-        queue_cv_.notify_all() ;
+        p_::task_runner< result_type , bound_type > runner { state } ;
+        
+        state -> add_ref() ;
+        future< result_type > result = p_::future_access::create( p_::state_ptr< result_type >{ state } ) ;
+        
+        enqueue( task_type( std::move( runner ) ) ) ;
+        return result ;
+    }
+    
+    // false if the queue is full ; the_task is left untouched then. 
+    // for unbounded queues it is the same as enqueue (). 
+    // for bounded ones the task is not stamped for the queue wait stats , as it has to stay untouched.
+    bool try_enqueue ( task_type& the_task ) 
+    {
+        return try_enqueue_( the_task , is_bounded{} ) ;
+    }
+    
+    // enqueues the_task , or runs it on the calling thread if a bounded queue is full ( false then ). 
+    // it is stamped for the stats as by enqueue () , and run in place it is counted as a task of the pool. 
+    // lets task_group fork without waiting for a cell that only the threads it waits for could free.
+    bool enqueue_or_run ( task_type the_task ) 
+    {
+        return enqueue_or_run_( the_task , is_bounded{} ) ;
     }
     
+    // tasks are moved from the range ; on exception it points to the first task that was not enqueued. 
+    // wakes up no more threads than there are new tasks.
+    template < class InputIt >
+    void enqueue ( InputIt& it , InputIt to ) 
+    {
+        enqueue_( it , to , is_concurrent{} ) ;
+    }
+    
+    // runs one queued task on the calling thread , if there is any and the pool is not paused. 
+    // lets a thread that waits for some of the tasks ( task_group::wait ) help instead of blocking.
+    bool run_pending_task () 
+    {
+        return run_pending_task_( is_concurrent{} ) ;
+    }
+    
+    // how many tasks a thread takes from the queue per one queue_mtx_ acquisition ( 1 by default ). 
+    // tasks of a batch are executed in a row , so more than 1 trades priorities / fairness 
+    // of the queue for less locking ; taken tasks that are not started before pause () are put back.
+    // concurrent queues are not locked to pop , so it is ignored for them.
+    void set_dequeue_batch ( std::size_t const batch ) 
+    {
+        if ( ! batch ) 
+            throw std::invalid_argument{ "dequeue batch must not be empty" } ;
+        
+        lock_guard< mutex > lock { queue_mtx_ } ;
+        dequeue_batch_ = batch ;
+    }
+    
+    
+    std::size_t thread_count () 
+    {
+        lock_guard< mutex > lock { queue_mtx_ } ;
+        return thread_count_ ;
+    }
+    
+    // there are threads and they are not paused , so queued tasks are going to be run
+    bool is_executing () 
+    {
+        lock_guard< mutex > lock { queue_mtx_ } ;
+        return state_ == EXECUTING && thread_count_ != 0 ;
+    }
     
     bool pause () 
     {
@@ -299,6 +468,8 @@ struct thread_pool final
         
         state_ = EXECUTING ;
         queue_cv_.notify_all() ;
+        if ( blocked_count_.load() ) // tasks of the pool parked in enqueue () may run the new task in place now
+            space_cv_.notify_all() ;
         return true ;
     }
     
@@ -306,35 +477,576 @@ struct thread_pool final
         return * reinterpret_cast< ThreadExceptionPolicy * >( this ) ;
     }
     
+    // e.g. pool.stats_policy().snapshot() for CollectPoolStats
+    stats_policy_type& stats_policy () noexcept {
+        return stats_ ;
+    }
+    
     private :
         
-        void routine () try
+        void join_ ( std::false_type ) 
+        {
+            unique_lock< mutex > lock { queue_mtx_ } ;
+            wait_client_( lock , 
+                          [ this ] ( ) { return queue_.empty() && active_count_ == 0 && helping_count_ == 0 ; } ) ;
+        }
+        
+        void join_ ( std::true_type ) 
+        {
+            unique_lock< mutex > lock { queue_mtx_ } ;
+            wait_client_( lock , 
+                          [ this ] ( ) { return unfinished_count_.load() == 0 ; } ) ;
+        }
+        
+        void discard_queue_ ( std::false_type ) 
+        { 
+            lock_guard< mutex > lock { queue_mtx_ } ;
+            ++ discard_count_ ; // the batches taken before are dropped too , see routine_
+            while ( ! queue_.empty() ) 
+                queue_.pop() ;
+        }
+        
+        void discard_queue_ ( std::true_type ) 
+        { 
+            std::size_t discarded ;
+            {
+                lock_guard< mutex > lock { queue_mtx_ } ;
+                ++ discard_count_ ; // before the clear ; see drop_if_discarded_
+                discarded = queue_.clear() + returned_.size() ;
+                returned_.clear() ;
+                queue_cv_.notify_all() ; // parked workers drop their held tasks
+            }
+            if ( discarded ) 
+                space_released_( is_bounded{} ) ;
+            finish_tasks_( discarded ) ;
+        }
+        
+        bool run_pending_task_ ( std::false_type ) 
+        {
+            unique_lock< mutex > lock { queue_mtx_ , defer_lock } ;
+            lock_queue_( lock ) ;
+            if ( state_ == PAUSED || queue_.empty() ) 
+                return false ;
+            
+            task_type task = std::move( queue_.front() ) ;
+            queue_.pop() ;
+            
+            ++ helping_count_ ;
+            lock.unlock() ;
+            
+            auto lock_again_at_the_end = 
+                p_::make_guard( [ this , &lock ] () { 
+                    lock_queue_( lock ) ; 
+                    -- helping_count_ ;
+                    notify_clients_() ;
+                } ) ;
+            
+            run_helping_( task ) ;
+            return true ;
+        }
+        
+        bool run_pending_task_ ( std::true_type ) 
+        {
+            task_type task ;
+            if ( state_ == PAUSED || ! try_pop_( task ) ) 
+                return false ;
+            
+            if ( state_ == PAUSED ) { // see routine_ ; the workers take it after resume () 
+                std::size_t const discards = discard_count_.load() ;
+                lock_guard< mutex > lock { queue_mtx_ } ;
+                bool is_held = true ;
+                drop_if_discarded_( task , is_held , discards ) ;
+                if ( is_held ) {
+                    returned_.push_back( std::move( task ) ) ;
+                    queue_cv_.notify_one() ; // resume () could be already done
+                }
+                return false ;
+            }
+            
+            run_helping_( task ) ;
+            
+            task = task_type() ;
+            finish_tasks_( 1 ) ;
+            return true ;
+        }
+        
+        void enqueue_ ( task_type the_task , std::false_type ) 
+        {
+            unique_lock< mutex > lock { queue_mtx_ , defer_lock } ;
+            lock_queue_( lock ) ;
+            queue_.emplace( std::move( the_task ) ) ;
+            queue_cv_.notify_one() ; // vs chained notify_one whith mutex unlocked (prof).?
+            stats_.notified( 1 ) ;
+        }
+        
+        void enqueue_ ( task_type the_task , std::true_type ) 
+        {
+            ++ unfinished_count_ ;
+            
+            try { push_( the_task , is_bounded{} ) ; }
+            catch ( ... ) {
+                finish_tasks_( 1 ) ;
+                throw ;
+            }
+            wake_one_() ;
+        }
+        
+        template < class... Args >
+        void emplace_stamped_ ( std::false_type , Args&&... args ) 
+        {
+            emplace_( is_concurrent{} , std::forward< Args >( args )... ) ;
+        }
+        
+        template < class... Args >
+        void emplace_stamped_ ( std::true_type , Args&&... args ) 
+        {
+            enqueue( task_type( std::forward< Args >( args )... ) ) ;
+        }
+        
+        template < class... Args >
+        void emplace_ ( std::false_type , Args&&... args ) 
+        {
+            unique_lock< mutex > lock { queue_mtx_ , defer_lock } ;
+            lock_queue_( lock ) ;
+            queue_.emplace( std::forward< Args >( args )... ) ;
+            queue_cv_.notify_one() ;
+            stats_.notified( 1 ) ;
+        }
+        
+        template < class... Args >
+        void emplace_ ( std::true_type , Args&&... args ) 
+        {
+            ++ unfinished_count_ ;
+            
+            try { emplace_into_( is_bounded{} , std::forward< Args >( args )... ) ; }
+            catch ( ... ) {
+                finish_tasks_( 1 ) ;
+                throw ;
+            }
+            wake_one_() ;
+        }
+        
+        template < class... Args >
+        void emplace_into_ ( std::false_type , Args&&... args ) 
+        {
+            queue_.emplace( std::forward< Args >( args )... ) ;
+        }
+        
+        template < class... Args >
+        void emplace_into_ ( std::true_type , Args&&... args ) 
+        {
+            // args are left untouched if the queue is full
+            if ( try_emplace_( std::is_nothrow_constructible< task_type , Args&&... >{} , 
+                               std::forward< Args >( args )... ) ) 
+                return ;
+            
+            task_type the_task ( std::forward< Args >( args )... ) ;
+            push_( the_task , std::true_type{} ) ;
+        }
+        
+        template < class... Args >
+        bool try_emplace_ ( std::true_type , Args&&... args ) 
+        {
+            return queue_.try_emplace( std::forward< Args >( args )... ) ;
+        }
+        
+        template < class... Args >
+        bool try_emplace_ ( std::false_type , Args&&... ) 
+        {
+            return false ;
+        }
+        
+        bool try_enqueue_ ( task_type& the_task , std::false_type ) 
+        {
+            enqueue( std::move( the_task ) ) ;
+            return true ;
+        }
+        
+        bool try_enqueue_ ( task_type& the_task , std::true_type ) 
+        {
+            ++ unfinished_count_ ;
+            
+            if ( ! queue_.try_push( the_task ) ) {
+                finish_tasks_( 1 ) ;
+                return false ;
+            }
+            wake_one_() ;
+            return true ;
+        }
+        
+        // the_task is stamped as by enqueue () ; it is handed back stamped if the queue is full
+        bool try_push_stamped_ ( task_type& the_task ) 
+        {
+            task_type stamped = stamp_( std::move( the_task ) , is_stats_enabled{} ) ;
+            if ( queue_.try_push( stamped ) ) 
+                return true ;
+            
+            the_task = std::move( stamped ) ;
+            return false ;
+        }
+        
+        bool enqueue_or_run_ ( task_type& the_task , std::false_type ) 
+        {
+            enqueue( std::move( the_task ) ) ;
+            return true ;
+        }
+        
+        bool enqueue_or_run_ ( task_type& the_task , std::true_type ) 
+        {
+            ++ unfinished_count_ ;
+            
+            if ( try_push_stamped_( the_task ) ) {
+                wake_one_() ;
+                return true ;
+            }
+            
+            auto finish = p_::make_guard( [ this ] () { finish_tasks_( 1 ) ; } ) ;
+            run_helping_( the_task ) ;
+            return false ;
+        }
+        
+        void push_ ( task_type& the_task , std::false_type ) 
+        {
+            queue_.push( std::move( the_task ) ) ;
+        }
+        
+        // producer is parked on space_cv_ until a consumer frees a cell ; 
+        // the same handshake as for sleeping_count_ , but with roles swapped.
+        // a task of this pool is not parked : if all the workers waited for a cell , nobody would free one ; 
+        // the new task is run in place instead ( callers have counted it in unfinished_count_ already ). 
+        // the nesting is capped , as a task may enqueue its successor into the queue that stays full ; 
+        // past max_inline_depth the task is parked as any other producer. while the pool is paused 
+        // it is parked too , till a cell is freed or resume () lets it run in place.
+        void push_ ( task_type& the_task , std::true_type ) 
+        {
+            if ( queue_.try_push( the_task ) ) 
+                return ;
+            
+            std::size_t& depth = inline_depth_() ;
+            bool const may_run_in_place = running_pool_() == this && depth < max_inline_depth ;
+            
+            if ( ! may_run_in_place || state_ == PAUSED ) 
+            {
+                unique_lock< mutex > lock { queue_mtx_ } ;
+                
+                ++ blocked_count_ ;
+                std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+                
+                if ( sleeping_count_.load() ) // tasks of a range enqueue are not announced yet
+                    queue_cv_.notify_all() ;
+                
+                auto unblock = p_::make_guard( [ this ] () { -- blocked_count_ ; } ) ;
+                
+                bool is_pushed = false ;
+                space_cv_.wait( lock , [ this , &the_task , &is_pushed , may_run_in_place ] ( ) { 
+                    is_pushed = queue_.try_push( the_task ) ;
+                    return is_pushed || ( may_run_in_place && state_ != PAUSED ) ; 
+                } ) ;
+                if ( is_pushed ) 
+                    return ;
+            }
+            
+            ++ depth ;
+            auto finish = p_::make_guard( [ this , &depth , &the_task ] () { 
+                -- depth ;
+                the_task = task_type() ;
+                finish_tasks_( 1 ) ;
+            } ) ;
+            run_task_( the_task ) ;
+        }
+        
+        void space_released_ ( std::false_type ) 
+        {
+        }
+        
+        void space_released_ ( std::true_type ) 
+        {
+            std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+            if ( blocked_count_.load() ) {
+                lock_guard< mutex > lock { queue_mtx_ } ;
+                space_cv_.notify_all() ;
+            }
+        }
+        
+        bool take_returned_ ( task_type& the_task ) // queue_mtx_
+        {
+            if ( returned_.empty() ) 
+                return false ;
+            
+            the_task = std::move( returned_.back() ) ;
+            returned_.pop_back() ;
+            return true ;
+        }
+        
+        bool try_pop_ ( task_type& the_task ) 
+        {
+            if ( ! queue_.try_pop( the_task ) ) 
+                return false ;
+            
+            space_released_( is_bounded{} ) ;
+            return true ;
+        }
+        
+        template < class InputIt >
+        void enqueue_ ( InputIt& it , InputIt to , std::false_type )
+        {
+            unique_lock< mutex > lock { queue_mtx_ , defer_lock } ;
+            lock_queue_( lock ) ;
+            
+            std::size_t count = 0 ;
+            auto wake_for_enqueued = p_::make_guard( [ this , &count ] () { 
+                std::size_t const idle = thread_count_ - active_count_ ;
+                
+                if ( count >= idle ) 
+                    queue_cv_.notify_all() ;
+                else 
+                    for ( std::size_t woken = 0 ; woken < count ; ++ woken ) 
+                        queue_cv_.notify_one() ;
+                stats_.notified( count < idle ? count : idle ) ;
+            } ) ;
+            
+            for ( ; it != to ; ++ it , ++ count ) 
+                queue_.emplace( stamp_( std::move( * it ) , is_stats_enabled{} ) ) ;
+        }
+        
+        template < class InputIt >
+        void enqueue_ ( InputIt& it , InputIt to , std::true_type )
+        {
+            std::size_t count = 0 ;
+            auto wake_for_enqueued = p_::make_guard( [ this , &count ] () { wake_( count ) ; } ) ;
+            
+            for ( ; it != to ; ++ it , ++ count ) 
+            {
+                ++ unfinished_count_ ;
+                
+                try { 
+                    task_type the_task = stamp_( std::move( * it ) , is_stats_enabled{} ) ;
+                    push_( the_task , is_bounded{} ) ; 
+                }
+                catch ( ... ) {
+                    finish_tasks_( 1 ) ;
+                    throw ;
+                }
+            }
+        }
+        
+        // a worker increments sleeping_count_ and then checks the queue , a producer pushes 
+        // and then checks sleeping_count_ ; with the fences in between , at least one of them sees the other.
+        void wake_one_ () 
+        {
+            std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+            if ( sleeping_count_.load() ) {
+                unique_lock< mutex > lock { queue_mtx_ , defer_lock } ;
+                lock_queue_( lock ) ;
+                queue_cv_.notify_one() ;
+                stats_.notified( 1 ) ;
+            }
+        }
+        
+        void wake_ ( std::size_t const count ) 
+        {
+            if ( ! count ) 
+                return ;
+            
+            std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+            std::size_t const sleeping = sleeping_count_.load() ;
+            if ( ! sleeping ) 
+                return ;
+            
+            unique_lock< mutex > lock { queue_mtx_ , defer_lock } ;
+            lock_queue_( lock ) ;
+            if ( count >= sleeping ) 
+                queue_cv_.notify_all() ;
+            else 
+                for ( std::size_t woken = 0 ; woken < count ; ++ woken ) 
+                    queue_cv_.notify_one() ;
+            stats_.notified( count < sleeping ? count : sleeping ) ;
+        }
+        
+        // client_cv_ is notified only if somebody waits on it ; otherwise workers would signal 
+        // it a few times per task for nothing.
+        template < class Predicate >
+        void wait_client_ ( unique_lock< mutex >& lock , Predicate pred ) // queue_mtx_
+        {
+            ++ client_waiters_ ;
+            auto leave = p_::make_guard( [ this ] () { -- client_waiters_ ; } ) ;
+            
+            client_cv_.wait( lock , std::move( pred ) ) ;
+        }
+        
+        void notify_clients_ () // queue_mtx_
+        {
+            if ( client_waiters_ ) 
+                client_cv_.notify_all() ;
+        }
+        
+        // a task popped while the pool was being paused is still queued from the point of view of 
+        // discard_queue () ; it is dropped if discard_queue () has started since the pop. 
+        // discards is read after the pop , so a task enqueued after discard_queue () returned is kept.
+        void drop_if_discarded_ ( task_type& the_task , bool& is_held , std::size_t const discards ) // queue_mtx_
+        {
+            if ( ! is_held || discards == discard_count_.load() ) 
+                return ;
+            
+            is_held = false ;
+            the_task = task_type() ;
+            if ( unfinished_count_.fetch_sub( 1 ) == 1 ) 
+                notify_clients_() ;
+        }
+        
+        void finish_tasks_ ( std::size_t const count ) 
+        {
+            if ( count && unfinished_count_.fetch_sub( count ) == count ) {
+                unique_lock< mutex > lock { queue_mtx_ , defer_lock } ;
+                lock_queue_( lock ) ;
+                notify_clients_() ;
+            }
+        }
+        
+        // the hot acquisitions of queue_mtx_ go through it ; with the stats enabled , 
+        // a failed try_lock is counted as contention.
+        void lock_queue_ ( unique_lock< mutex >& lock ) 
+        {
+            lock_queue_( lock , is_stats_enabled{} ) ;
+        }
+        
+        void lock_queue_ ( unique_lock< mutex >& lock , std::false_type ) 
+        {
+            lock.lock() ;
+        }
+        
+        void lock_queue_ ( unique_lock< mutex >& lock , std::true_type ) 
+        {
+            if ( lock.try_lock() ) 
+                return ;
+            
+            stats_.lock_contended() ;
+            lock.lock() ;
+        }
+        
+        void run_task_ ( task_type& task ) 
+        {
+            run_task_( task , is_stats_enabled{} ) ;
+        }
+        
+        void run_task_ ( task_type& task , std::false_type ) 
+        {
+            try { task() ; }
+            catch ( ... ) { /* todo ; may throw in future */ }
+        }
+        
+        void run_task_ ( task_type& task , std::true_type ) 
         {
+            auto const started = std::chrono::steady_clock::now() ;
+            
+            try { task() ; }
+            catch ( ... ) { /* todo ; may throw in future */ }
+            
+            stats_.task_run( std::chrono::duration_cast< std::chrono::nanoseconds >( 
+                                std::chrono::steady_clock::now() - started ) ) ;
+        }
+        
+        // with the stats enabled a task is wrapped to record how long it has been queued
+        template < class T >
+        T&& stamp_ ( T&& the_task , std::false_type ) 
+        {
+            return std::forward< T >( the_task ) ;
+        }
+        
+        template < class T >
+        task_type stamp_ ( T&& the_task , std::true_type ) 
+        {
+            return task_type( p_::stamped_task< task_type , stats_policy_type >{ 
+                                &stats_ , std::chrono::steady_clock::now() , task_type( std::forward< T >( the_task ) ) } ) ;
+        }
+        
+        // the first evaluation of a wait predicate is done before the thread parks , 
+        // each next one follows a wakeup ; it is futile if there is nothing to do.
+        template < class Predicate >
+        Predicate watch_wakeups_ ( Predicate pred , std::false_type ) 
+        {
+            return pred ;
+        }
+        
+        template < class Predicate >
+        p_::woken_predicate< stats_policy_type , Predicate > watch_wakeups_ ( Predicate pred , std::true_type ) 
+        {
+            return { &stats_ , std::move( pred ) , true } ;
+        }
+        
+        // the lowest placement index that no thread has , so a thread added after remove_thread () 
+        // is placed as the removed one was
+        std::size_t take_placement_index_ () // queue_mtx_
+        {
+            std::size_t index = 0 ;
+            while ( index < placement_used_.size() && placement_used_[ index ] ) 
+                ++ index ;
+            
+            if ( index == placement_used_.size() ) 
+                placement_used_.push_back( true ) ;
+            else 
+                placement_used_[ index ] = true ;
+            return index ;
+        }
+        
+        void routine ( std::size_t const placement_index ) 
+        {
+            running_pool_() = this ;
+            routine_( is_concurrent{} , placement_index ) ;
+        }
+        
+        // the pool whose task the calling thread runs , as a worker or in run_pending_task () 
+        static thread_pool *& running_pool_ () noexcept 
+        {
+            static thread_local thread_pool * pool = nullptr ;
+            return pool ;
+        }
+        
+        // tasks the calling thread runs in place from push_ , one inside of another 
+        static std::size_t& inline_depth_ () noexcept 
+        {
+            static thread_local std::size_t depth = 0 ;
+            return depth ;
+        }
+        
+        void run_helping_ ( task_type& the_task ) 
+        {
+            thread_pool * const prev_pool = running_pool_() ;
+            running_pool_() = this ;
+            auto restore = p_::make_guard( [ prev_pool ] () { running_pool_() = prev_pool ; } ) ;
+            
+            run_task_( the_task ) ;
+        }
+        
+        // a thread takes up to dequeue_batch_ tasks per queue_mtx_ acquisition ; 
+        // the ones not started because of pause () are put back to the queue with emplace , so a fifo queue
+        // runs them after the tasks enqueued meanwhile. the batch is still queued for discard_queue () : 
+        // the tasks not started when it is called are dropped.
+        void routine_ ( std::false_type , std::size_t const placement_index ) try
+        {
+            stats_.worker_started() ;
+            
             unique_lock< mutex > lock { queue_mtx_ } ;
             
             ++ thread_count_ ;
-            bool is_active ;
             
             auto on_thread_exit = 
-                p_::make_guard( [ this , &is_active , &lock ] () {
+                p_::make_guard( [ this , &lock , placement_index ] () {
                     assert( lock ) ;
+                    placement_used_[ placement_index ] = false ;
                     -- thread_count_ ;
-                    if ( is_active )
-                        -- active_count_ ;
-                    client_cv_.notify_all() ;
+                    notify_clients_() ;
                 } ) ;
             
+            std::vector< task_type > batch ;
+            
             for ( ; ; )
             {
-            
-                is_active = false ;
-                if ( active_count_ ) 
-                    -- active_count_ ;
-                
-                client_cv_.notify_all() ;
+                notify_clients_() ;
                 
-                queue_cv_.wait( lock , [ this ] ( ) { return action_.any() 
-                                                            || ( state_ != PAUSED && ! queue_.empty() ) ; } ) ;
+                queue_cv_.wait( lock , watch_wakeups_( [ this ] ( ) { return action_.any() 
+                                                                            || ( state_ != PAUSED && ! queue_.empty() ) ; } , 
+                                                       is_stats_enabled{} ) ) ;
                 
                 if ( action_[ FINISH ] ) 
                 {
@@ -348,23 +1060,132 @@ struct thread_pool final
                         action_[ FINISH_ALL ] = false ;
                     break ;
                 }
-                    
-                task_type task = std::move( queue_.front() ) ;
-                queue_.pop() ;
                 
-                is_active = true ;
+                std::size_t const discards = discard_count_.load() ;
+                batch.reserve( dequeue_batch_ ) ;
+                do {
+                    batch.push_back( std::move( queue_.front() ) ) ;
+                    queue_.pop() ;
+                } while ( batch.size() < dequeue_batch_ && ! queue_.empty() ) ;
+                
                 ++ active_count_ ;
                 
-                client_cv_.notify_all() ;
+                lock.unlock () ;
+                
+                std::size_t done = 0 ;
+                for ( ; done < batch.size() ; ++ done ) 
+                {
+                    if ( done && ( state_ == PAUSED || discards != discard_count_.load() ) ) 
+                        break ;
+                    
+                    run_task_( batch[ done ] ) ;
+                }
+                
+                lock_queue_( lock ) ;
+                -- active_count_ ;
+                
+                auto clear_batch = p_::make_guard( [ &batch ] () { batch.clear() ; } ) ;
+                if ( discards != discard_count_.load() ) 
+                    continue ;
+                
+                for ( ; done < batch.size() ; ++ done ) 
+                    queue_.emplace( std::move( batch[ done ] ) ) ;
+            } 
+        } catch ( ... ) 
+          {
+              exception_policy_type::thread_exception_handle( std::current_exception() ) ;
+          }
+        
+        // active_count_ here is a count of threads that are not parked on queue_cv_ ; 
+        // a thread keeps popping without queue_mtx_ until the queue is drained or the pool is paused.
+        void routine_ ( std::true_type , std::size_t const placement_index ) try
+        {
+            stats_.worker_started() ;
+            
+            unique_lock< mutex > lock { queue_mtx_ } ;
+            
+            ++ thread_count_ ;
+            queue_.attach_worker() ;
+            
+            auto on_thread_exit = 
+                p_::make_guard( [ this , &lock , placement_index ] () {
+                    assert( lock ) ;
+                    placement_used_[ placement_index ] = false ;
+                    queue_.detach_worker() ;
+                    -- thread_count_ ;
+                    notify_clients_() ;
+                } ) ;
+            
+            task_type task ;
+            bool is_held = false ; // popped without queue_mtx_ , while the pool was being paused
+            std::size_t held_discards = 0 ; // discard_count_ right after the held task was popped
+            
+            for ( ; ; )
+            {
+                notify_clients_() ;
+                
+                ++ sleeping_count_ ;
+                std::atomic_thread_fence( std::memory_order_seq_cst ) ;
                 
+                auto awake = p_::make_guard( [ this ] () { -- sleeping_count_ ; } ) ;
+                
+                queue_cv_.wait( lock , watch_wakeups_( [ this , &task , &is_held , held_discards ] ( ) { 
+                    drop_if_discarded_( task , is_held , held_discards ) ;
+                    return action_.any() 
+                           || ( state_ != PAUSED && ( is_held || take_returned_( task ) || queue_.try_pop( task ) ) ) ; 
+                } , is_stats_enabled{} ) ) ;
+                awake.perform() ;
+                
+                if ( is_bounded::value && ! action_.any() ) { // a cell was freed under queue_mtx_ , see space_released_
+                    std::atomic_thread_fence( std::memory_order_seq_cst ) ;
+                    if ( blocked_count_.load() ) 
+                        space_cv_.notify_all() ;
+                }
+                
+                if ( action_[ FINISH ] ) 
+                {
+                    if ( is_held ) 
+                        returned_.push_back( std::move( task ) ) ;
+                    
+                    if ( ! action_[ FINISH_ALL ] ) {
+                        action_[ FINISH ] = false ;
+                        break ;
+                    }
+                    
+                    if ( thread_count_ == 1 ) // last one
+                        action_[ FINISH_ALL ] = false ;
+                    break ;
+                }
+                
+                is_held = false ;
+                ++ active_count_ ;
                 
                 lock.unlock () ;
                 
                 auto lock_again_at_the_end = 
-                    p_::make_guard( [ this , &lock ] () { lock.lock() ; } ) ;
-
-                try { task() ; }
-                catch ( ... ) { /* todo ; may throw in future */ }
+                    p_::make_guard( [ this , &lock ] () { 
+                        lock_queue_( lock ) ; 
+                        -- active_count_ ;
+                    } ) ;
+                
+                for ( ; ; ) 
+                {
+                    run_task_( task ) ;
+                    
+                    task = task_type() ;
+                    finish_tasks_( 1 ) ;
+                    
+                    if ( state_ == PAUSED || ! try_pop_( task ) ) 
+                        break ;
+                    
+                    // pause () could happen between the check and the pop ; the task may be enqueued 
+                    // after pause () returned , so it has to wait for resume () .
+                    if ( state_ == PAUSED ) { 
+                        is_held = true ;
+                        held_discards = discard_count_.load() ;
+                        break ;
+                    }
+                }
             } 
         } catch ( ... ) 
           {
@@ -388,18 +1209,35 @@ struct thread_pool final
         mutex queue_mtx_ , op_mtx_ ; // op_mtx_ is used for operations that are waiting for rresponse ; can be locked only by thread_pool
                                      // must be locked strictly before queue_mtx_ 
         condition_variable queue_cv_ ,  // queue_mtx_ ; can be waited only within routine. 
-                           client_cv_ ; // queue_mtx_ ; waiters,  etc
+                           client_cv_ , // queue_mtx_ ; waiters,  etc
+                           space_cv_ ;  // queue_mtx_ ; is_bounded only , producers waiting for a free cell
         
         task_queue_type queue_ ;
+        std::vector< task_type > returned_ ; // queue_mtx_ ; is_concurrent only , held tasks of threads that have exited
         
+        thread_placement placement_ ; // op_mtx_
+        std::vector< bool > placement_used_ ; // queue_mtx_ ; placement_ indices of the threads , released on exit
         std::size_t thread_count_   ; // queue_mtx_                         || increased / decremented by working threads
         std::size_t active_count_   ; // queue_mtx_ + client_cv_.notify_all || increased / decremented by working threads
+        std::size_t helping_count_  ; // queue_mtx_ ; ! is_concurrent only , clients running a task in run_pending_task ()
+        std::size_t client_waiters_ ; // queue_mtx_ ; clients waiting on client_cv_ 
+        std::size_t dequeue_batch_  ; // queue_mtx_ ; ! is_concurrent only 
         
-        EPoolState state_  ;
+        std::atomic< std::size_t > sleeping_count_   ; // is_concurrent only ; threads that are about to wait / waiting on queue_cv_
+        std::atomic< std::size_t > unfinished_count_ ; // is_concurrent only ; enqueued , but not yet executed or discarded tasks
+        std::atomic< std::size_t > blocked_count_    ; // is_bounded only ; producers that are about to wait / waiting on space_cv_
+        std::atomic< std::size_t > discard_count_    ; // discard_queue () calls , incremented under queue_mtx_
+        
+        std::atomic< EPoolState > state_  ; // written under queue_mtx_
         std::bitset< EThreadAction_SZ > action_ ;
         
+        stats_policy_type stats_ ; // called concurrently , without queue_mtx_ 
+        
 } ; // thread_pool
 
+template < class Queue , class ThreadExceptionPolicy , class StatsPolicy >
+constexpr std::size_t thread_pool< Queue , ThreadExceptionPolicy , StatsPolicy >::max_inline_depth ;
+
 } // multi
 
 
@@ -415,100 +1253,5 @@ struct EventScheduler
 } ;
 
 
-struct notify_counter final
-{
-    using value_type = unsigned long long ;
-    
-    notify_counter& operator ++ () noexcept { ++ count_ ; return * this ; }
-    
-    private :
-        value_type count_ = 0 ; // 
-    
-    friend bool operator == ( notify_counter const& op0 ,  
-                              notify_counter const& op1 )
-    {
-        return op0.count_ == op1.count_ ;
-    }
-    
-    friend bool operator != ( notify_counter const& op0 ,  
-                              notify_counter const& op1 )
-    {
-        return op0.count_ != op1.count_ ;
-    }
-    
-    friend value_type operator - ( notify_counter const& recent , 
-                                   notify_counter const& later ) {
-        if ( recent.count_ < later.count_ ) {
-            return std::numeric_limits< value_type >::max - later.count_ + recent.count_ ;
-        }
-        return recent.count_ - later.count_ ;
-    }
-} ;
-
-template < class T >
-struct future final
-{
-    template < class Rep , class  >
-    bool wait_until( counter_integer_t count , std::chrono::time_point< Rep ,  > )
-    {
-        
-    }
-    template < class Rep , class  >
-    bool wait_for( counter_integer_t count , std::chrono::duration< Rep ,  > )
-    {
-        
-    }
-    
-    
-    
-    private :
-} ;
-
-template < class T >
-struct promise final
-{
-    private :
-} ;
-
-struct counter final
-{
-    using counter_integer_t = unsigned long long ;
-
-    
-    
-    
-
-    private :
- 
-} ;
-
-template < class >
-struct task final
-{
-    template< class F , class... Args >
-    task( F&& f , Args&&... args )
-    {
-        task_ = std::bind( std::forward< F >( f ) ,
-                           std::forward< Args >( args )... )
-    }
-    
-    void execute() noexcept 
-    {
-        multi::unique_lock
-        try { task_() ; } 
-        catch( ... ) {
-            ptr_ = std::current_exception() ;
-        }
-        cv_.notify_all() ;
-    }
-    
-    private :
-        multi::mutex mtx_ ;
-        multi::condition_variable cv_ ;
-        std::exception_ptr ptr_ ;
-        std::function< void() > task_ ;
-} ;
-
-
 */
 #endif 
@@ -0,0 +1,82 @@
+#ifndef MULTI_TOPOLOGY_HXX
+#define MULTI_TOPOLOGY_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "thread.hxx"
+
+#if defined MULTI_POSIX_PLATFORM || defined MULTI_LINUX_FUTEX_PLATFORM
+    #include "sources/POSIX/topology.hxx"
+#elif defined MULTI_WINAPI_PLATFORM
+    #include "sources/WinAPI/topology.hxx"
+#endif
+
+namespace multi
+{
+    // attributes of the index-th worker of a thread_pool ( see thread_pool::set_thread_placement ).
+    //   any  - not pinned ;
+    //   core - one cpu per worker ; cpus are taken node by node , so neighbouring workers share a node ;
+    //   node - all cpus of a node per worker ; workers are spread over the nodes round robin.
+    // a not empty name of the base attributes gets the index appended.
+    struct thread_placement final
+    {
+        enum struct mode
+        {
+            any ,
+            core ,
+            node
+        } ;
+
+        thread_placement () : mode_{ mode::any } { }
+
+        explicit thread_placement ( mode const placement_mode , thread::attributes base = thread::attributes{} )
+            : mode_{ placement_mode } , base_( std::move( base ) )
+        {
+        }
+
+        thread::attributes operator () ( std::size_t const index ) const
+        {
+            thread::attributes attrs = base_ ;
+
+            if ( ! attrs.name.empty() )
+                attrs.name += std::to_string( index ) ;
+
+            if ( mode_ == mode::any )
+                return attrs ;
+
+            cpu_topology const& topology = cpu_topology::get() ;
+
+            if ( mode_ == mode::node ) {
+                attrs.cpus = topology.node_cpus( index % topology.node_count() ) ;
+                return attrs ;
+            }
+
+            std::size_t cpu_count = 0 ;
+            for ( std::size_t node = 0 ; node < topology.node_count() ; ++ node )
+                cpu_count += topology.node_cpus( node ).size() ;
+
+            std::size_t cpu_index = index % cpu_count ;
+            for ( std::size_t node = 0 ; ; ++ node )
+            {
+                std::vector< unsigned > const& cpus = topology.node_cpus( node ) ;
+                if ( cpu_index < cpus.size() ) {
+                    attrs.cpus.assign( 1 , cpus[ cpu_index ] ) ;
+                    return attrs ;
+                }
+                cpu_index -= cpus.size() ;
+            }
+        }
+
+        mode placement_mode () const noexcept { return mode_ ; }
+
+        private :
+            mode mode_ ;
+            thread::attributes base_ ;
+    } ;
+}
+
+#endif // MULTI_TOPOLOGY_HXX
@@ -0,0 +1,249 @@
+#ifndef MULTI_WORK_STEALING_QUEUE_HXX
+#define MULTI_WORK_STEALING_QUEUE_HXX
+
+// GreenTree 2017 highcastle.cxx@gmail.com , MIT
+
+// every pool thread owns a deque : tasks pushed from a pool thread go to the back of its own deque
+// and are popped back from there ( LIFO , the data is still hot ) , while idle threads steal from
+// the front of deques of other threads ( FIFO , oldest / biggest pieces of work ).
+// tasks pushed from outside of the pool go to the shared injection deque.
+// each deque has its own mutex , so the contention is split between the owner and occasional thieves.
+// on a numa machine a thread steals from threads of its own node first ( the node is the one
+// the thread runs on when it attaches , so it is exact for pinned threads , see thread_placement ).
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+#include "mutex.hxx"
+#include "topology.hxx"
+#include "queue_traits.hxx"
+
+namespace multi
+{
+    template < class T >
+    struct work_stealing_queue final
+    {
+        using value_type = T ;
+        using queue_category = concurrent_queue_tag ;
+
+        static constexpr std::size_t default_max_workers = 64 ;
+
+        explicit work_stealing_queue ( std::size_t const max_workers = default_max_workers )
+            : slots_( new slot_[ max_workers ] ) ,
+              max_workers_{ max_workers } , used_slots_{ 0 } ,
+              is_numa_{ cpu_topology::get().node_count() > 1 }
+        {
+        }
+
+        work_stealing_queue ( work_stealing_queue const& ) = delete ;
+        work_stealing_queue& operator = ( work_stealing_queue const& ) = delete ;
+
+        void push ( value_type value )
+        {
+            emplace( std::move( value ) ) ;
+        }
+
+        template < class... Args >
+        void emplace ( Args&&... args )
+        {
+            worker_ctx_ const& ctx = local_() ;
+
+            slot_& target = ( ctx.owner == this ) ? slots_[ ctx.index ] : injection_ ;
+
+            lock_guard< mutex > lock { target.mtx } ;
+            target.tasks.emplace_back( std::forward< Args >( args )... ) ;
+            target.size.store( target.tasks.size() , std::memory_order_relaxed ) ;
+        }
+
+        bool try_pop ( value_type& value )
+        {
+            worker_ctx_ const& ctx = local_() ;
+
+            bool const is_worker = ctx.owner == this ;
+
+            if ( is_worker && pop_back_( slots_[ ctx.index ] , value ) )
+                return true ;
+
+            if ( pop_front_( injection_ , value ) )
+                return true ;
+
+            if ( is_worker && is_numa_ )
+                return steal_( ctx , value , same_node ) || steal_( ctx , value , other_nodes ) ;
+
+            return steal_( ctx , value , any_node ) ;
+        }
+
+        bool empty () const noexcept // note : only a hint while there are concurrent producers
+        {
+            if ( injection_.size.load( std::memory_order_relaxed ) )
+                return false ;
+
+            std::size_t const used = used_slots_.load( std::memory_order_acquire ) ;
+            for ( std::size_t index = 0 ; index < used ; ++ index )
+                if ( slots_[ index ].size.load( std::memory_order_relaxed ) )
+                    return false ;
+            return true ;
+        }
+
+        std::size_t clear ()
+        {
+            std::size_t discarded = clear_( injection_ ) ;
+
+            std::size_t const used = used_slots_.load( std::memory_order_acquire ) ;
+            for ( std::size_t index = 0 ; index < used ; ++ index )
+                discarded += clear_( slots_[ index ] ) ;
+            return discarded ;
+        }
+
+        // the thread gets own deque if there is a free one , otherwise it works through the injection deque.
+        // a deque that is left by a thread keeps its tasks ; they are stolen or picked up by the next owner.
+        void attach_worker ()
+        {
+            worker_ctx_& ctx = local_() ;
+
+            for ( std::size_t index = 0 ; index < max_workers_ ; ++ index )
+            {
+                bool expected = false ;
+                if ( slots_[ index ].owned.compare_exchange_strong( expected , true ) )
+                {
+                    std::size_t used = used_slots_.load( std::memory_order_relaxed ) ;
+                    while ( used <= index
+                            && ! used_slots_.compare_exchange_weak( used , index + 1 ,
+                                                                    std::memory_order_release ,
+                                                                    std::memory_order_relaxed ) )
+                    { }
+
+                    ctx.owner = this ;
+                    ctx.index = index ;
+                    ctx.node = is_numa_ ? cpu_topology::get().current_node() : 0 ;
+                    slots_[ index ].node.store( ctx.node , std::memory_order_relaxed ) ;
+                    return ;
+                }
+            }
+        }
+
+        void detach_worker () noexcept
+        {
+            worker_ctx_& ctx = local_() ;
+
+            if ( ctx.owner != this )
+                return ;
+
+            slots_[ ctx.index ].owned.store( false ) ;
+            ctx.owner = nullptr ;
+        }
+
+        private :
+
+            struct slot_
+            {
+                slot_ () : size{ 0 } , owned{ false } , node{ 0 } { }
+
+                mutex mtx ;
+                std::deque< value_type > tasks ; // mtx
+                std::atomic< std::size_t > size ; // mirrors tasks.size() , allows to skip empty deques without locking
+                std::atomic< bool > owned ;
+                std::atomic< std::size_t > node ; // of the last owner
+
+                char padding_[ p_::cache_line_size ] ; // separates hot slots from each other
+            } ;
+
+            struct worker_ctx_
+            {
+                work_stealing_queue const * owner ;
+                std::size_t index ;
+                std::size_t node ;
+            } ;
+
+            static worker_ctx_& local_ () noexcept
+            {
+                static thread_local worker_ctx_ ctx { nullptr , 0 , 0 } ;
+                return ctx ;
+            }
+
+            enum steal_scope_
+            {
+                any_node ,
+                same_node ,
+                other_nodes
+            } ;
+
+            // round robin from the next slot after own one , so thieves do not crowd on the first slots
+            bool steal_ ( worker_ctx_ const& ctx , value_type& value , steal_scope_ const scope )
+            {
+                bool const is_worker = ctx.owner == this ;
+
+                std::size_t const used = used_slots_.load( std::memory_order_acquire ) ;
+                std::size_t const start = is_worker ? ctx.index + 1 : 0 ;
+
+                for ( std::size_t count = 0 ; count < used ; ++ count )
+                {
+                    std::size_t const victim = ( start + count ) % used ;
+
+                    if ( is_worker && victim == ctx.index )
+                        continue ;
+
+                    if ( scope != any_node 
+                         && ( slots_[ victim ].node.load( std::memory_order_relaxed ) == ctx.node ) != ( scope == same_node ) )
+                        continue ;
+
+                    if ( pop_front_( slots_[ victim ] , value ) )
+                        return true ;
+                }
+                return false ;
+            }
+
+            static bool pop_back_ ( slot_& source , value_type& value )
+            {
+                if ( ! source.size.load( std::memory_order_relaxed ) )
+                    return false ;
+
+                lock_guard< mutex > lock { source.mtx } ;
+                if ( source.tasks.empty() )
+                    return false ;
+
+                value = std::move( source.tasks.back() ) ;
+                source.tasks.pop_back() ;
+                source.size.store( source.tasks.size() , std::memory_order_relaxed ) ;
+                return true ;
+            }
+
+            static bool pop_front_ ( slot_& source , value_type& value )
+            {
+                if ( ! source.size.load( std::memory_order_relaxed ) )
+                    return false ;
+
+                lock_guard< mutex > lock { source.mtx } ;
+                if ( source.tasks.empty() )
+                    return false ;
+
+                value = std::move( source.tasks.front() ) ;
+                source.tasks.pop_front() ;
+                source.size.store( source.tasks.size() , std::memory_order_relaxed ) ;
+                return true ;
+            }
+
+            static std::size_t clear_ ( slot_& source )
+            {
+                lock_guard< mutex > lock { source.mtx } ;
+                std::size_t const discarded = source.tasks.size() ;
+                source.tasks.clear() ;
+                source.size.store( 0 , std::memory_order_relaxed ) ;
+                return discarded ;
+            }
+
+            std::unique_ptr< slot_[] > slots_ ;
+            slot_ injection_ ;
+            std::size_t const max_workers_ ;
+            std::atomic< std::size_t > used_slots_ ; // slots_[ 0 , used_slots_ ) were owned at least once
+            bool const is_numa_ ;
+    } ;
+
+    template < class T >
+    constexpr std::size_t work_stealing_queue< T >::default_max_workers ;
+}
+
+#endif // MULTI_WORK_STEALING_QUEUE_HXX